@@ -107,6 +107,15 @@ public:
 	bool                EndOfPacket() const;
 
 	void                Reserve(uint32_t size);
+
+						// Append the CRC32C of everything in the packet so far (4 bytes).
+						// Call last, after all the data has been written.
+	void                AppendChecksum();
+
+						// For a packet ending with AppendChecksum(): if the checksum matches,
+						// remove it and return true. Otherwise, leave the packet alone and
+						// return false. Call before reading anything.
+	bool                VerifyChecksum();
 public:
 						// Overloads of operator >> to read data from the packet
 	Packet &            operator >>(bool &         data);
@@ -707,6 +716,30 @@ void Packet::Reserve(uint32_t size)
 	m_data.reserve(size);
 }
 
+FORCEINLINE
+void Packet::AppendChecksum()
+{
+	*this << Hash::CRC32C::Hash(m_data.data(), m_data.size());
+}
+
+FORCEINLINE
+bool Packet::VerifyChecksum()
+{
+	if (m_data.size() < sizeof(uint32_t))
+		return false;
+
+	std::size_t const payloadSize = m_data.size() - sizeof(uint32_t);
+
+	uint32_t stored;
+	std::memcpy(&stored, &m_data[payloadSize], sizeof(stored));
+
+	if (PACKET_ntohl(stored) != Hash::CRC32C::Hash(m_data.data(), payloadSize))
+		return false;
+
+	m_data.resize(payloadSize);
+	return true;
+}
+
 }
 
 /// I need to use these to make an implementation of the 64-bit bswap() operations, since some microcontrollers have no implementation.
@@ -67,14 +67,138 @@
 	#include <thread>
 #endif
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
+#include <utility>
+
+#include "../HandySystemInfo.hpp"
+
+#if defined IS_X64
+	#include <immintrin.h>
+#endif
 
 namespace HANDY_NS {
 
+namespace detail
+{
+	/// SHA1 compression of numBlocks consecutive 64 byte blocks into state.
+	inline void SHA1BlocksScalar(uint32_t * state, uint8_t const * data, size_t numBlocks)
+	{
+		auto rotl = [](uint32_t value, uint32_t shift) { return (value << shift) | (value >> (32 - shift)); };
+
+		for (; numBlocks > 0; numBlocks--, data += 64)
+		{
+			uint32_t word[80];
+
+			for (int i = 0; i < 16; ++i)
+				word[i] = (uint32_t(data[i * 4 + 0]) << 24) | (uint32_t(data[i * 4 + 1]) << 16) | (uint32_t(data[i * 4 + 2]) << 8) | uint32_t(data[i * 4 + 3]);
+
+			for (int i = 16; i < 80; ++i)
+				word[i] = rotl(word[i - 3] ^ word[i - 8] ^ word[i - 14] ^ word[i - 16], 1);
+
+			uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+			auto round = [&](uint32_t f, uint32_t w)
+			{
+				f += rotl(a, 5) + e + w;
+				e = d;
+				d = c;
+				c = rotl(b, 30);
+				b = a;
+				a = f;
+			};
+
+			for (int run =  0; run < 20; ++run) round(((b & c) | (~b & d))          + 0x5a827999, word[run]);
+			for (int run = 20; run < 40; ++run) round((b ^ c ^ d)                     + 0x6ed9eba1, word[run]);
+			for (int run = 40; run < 60; ++run) round(((b & c) | (b & d) | (c & d)) + 0x8f1bbcdc, word[run]);
+			for (int run = 60; run < 80; ++run) round((b ^ c ^ d)                     + 0xca62c1d6, word[run]);
+
+			state[0] += a; state[1] += b; state[2] += c; state[3] += d; state[4] += e;
+		}
+	}
+
+	#if defined IS_X64
+		/// Rounds 4G..4G+3 with the SHA extensions. The message schedule for later rounds is computed
+		/// alongside, in the 4 registers of msg used as a ring.
+		template <int G>
+		TARGET_ISA("sha,ssse3") FORCEINLINE void SHA1StepSHANI(__m128i & abcd, __m128i & e0, __m128i & e1, __m128i * msg, uint8_t const * data, __m128i mask)
+		{
+			__m128i & ea = (G % 2 == 0) ? e0 : e1;
+			__m128i & eb = (G % 2 == 0) ? e1 : e0;
+
+			if constexpr (G < 4)
+				msg[G] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(data + 16 * G)), mask);
+
+			__m128i & cur = msg[G % 4];
+
+			if constexpr (G == 0)
+				ea = _mm_add_epi32(ea, cur);
+			else
+				ea = _mm_sha1nexte_epu32(ea, cur);
+
+			eb = abcd;
+
+			if constexpr (G >= 3 && G <= 18)
+				msg[(G + 1) % 4] = _mm_sha1msg2_epu32(msg[(G + 1) % 4], cur);
+
+			abcd = _mm_sha1rnds4_epu32(abcd, ea, G / 5);
+
+			if constexpr (G >= 1 && G <= 16)
+				msg[(G + 3) % 4] = _mm_sha1msg1_epu32(msg[(G + 3) % 4], cur);
+
+			if constexpr (G >= 2 && G <= 17)
+				msg[(G + 2) % 4] = _mm_xor_si128(msg[(G + 2) % 4], cur);
+		}
+
+		template <int... G>
+		TARGET_ISA("sha,ssse3") FORCEINLINE void SHA1RoundsSHANI(__m128i & abcd, __m128i & e0, __m128i & e1, __m128i * msg, uint8_t const * data, __m128i mask, std::integer_sequence<int, G...>)
+		{
+			(SHA1StepSHANI<G>(abcd, e0, e1, msg, data, mask), ...);
+		}
+
+		TARGET_ISA("sha,ssse3") inline void SHA1BlocksSHANI(uint32_t * state, uint8_t const * data, size_t numBlocks)
+		{
+			__m128i const mask = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL); /// Big-endian words.
+
+			__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const *>(state)), 0x1B);
+			__m128i e0   = _mm_set_epi32(int(state[4]), 0, 0, 0);
+			__m128i e1;
+			__m128i msg[4];
+
+			for (; numBlocks > 0; numBlocks--, data += 64)
+			{
+				__m128i const abcdSave = abcd;
+				__m128i const e0Save   = e0;
+
+				SHA1RoundsSHANI(abcd, e0, e1, msg, data, mask, std::make_integer_sequence<int, 20>{});
+
+				e0   = _mm_sha1nexte_epu32(e0, e0Save);
+				abcd = _mm_add_epi32(abcd, abcdSave);
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(state), _mm_shuffle_epi32(abcd, 0x1B));
+			state[4] = uint32_t(_mm_cvtsi128_si32(_mm_srli_si128(e0, 12)));
+		}
+	#endif
+
+	using SHA1BlocksFn = void (*)(uint32_t * state, uint8_t const * data, size_t numBlocks);
+
+	inline SHA1BlocksFn PickSHA1Blocks()
+	{
+		#if defined IS_X64
+			CPUCapabilities const & cpu = CPUInfoCached();
+			if (cpu.SHA && cpu.SSSE3)
+				return SHA1BlocksSHANI;
+		#endif
+		return SHA1BlocksScalar;
+	}
+}
+
 class SHA1
 {
 public:
-	SHA1();
+	SHA1() = default;
 	
 	void Accumulate(uint8_t block);
 	void Accumulate(uint16_t block);
@@ -101,16 +225,16 @@ public:
 	static std::string NewUUIDString();
 
 private:
-	std::vector<uint8_t>       m_accumulator; // Never larger than "s_bufferNumBytes" bytes.
+	std::array<uint8_t, 64>    m_accumulator;          // Partial block, the first m_accumulatorSize bytes are valid.
+	size_t                     m_accumulatorSize = 0;
 	std::array<uint32_t, 5>    m_accHash = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
 
-	void                       transformAcc();
+	static void                transform(uint32_t * state, uint8_t const * data, size_t numBlocks);
 	std::array<uint32_t, 5>    currentHash();
-	uint32_t                   rotl(uint32_t value, uint32_t shift) const;
 
 	static constexpr uint64_t  s_arbitraryNumber = 0xA1DE7A1DE7A1DE70; // "AIDEN AIDEN AIDEN 0" Should be arbitrary...
 	static constexpr bool      s_isBigEndian = false; // TODO: Implement this someday when we actually care about ARM and/or Sun-Solaris.
-	static constexpr size_t    s_bufferNumBytes = 64; // MUST BE 64, unless you want to change the transformAcc() function.
+	static constexpr size_t    s_bufferNumBytes = 64; // SHA1 block size.
 
 	static uint64_t            getIncrementCounter() { static std::atomic<uint64_t> instance(0); return instance++; }
 	static uint64_t            getRandomNumber() 
@@ -123,74 +247,17 @@ private:
 	}
 };
 
-inline
-SHA1::SHA1()
-{
-	m_accumulator.reserve(s_bufferNumBytes);
-}
-
-inline uint32_t 
-SHA1::rotl(uint32_t value, uint32_t shift) const
-{
-	return ((value << shift) | (value >> (32 - shift)));
-}
-
 inline void
-SHA1::transformAcc()
+SHA1::transform(uint32_t * state, uint8_t const * data, size_t numBlocks)
 {
-	uint8_t * block_ = &m_accumulator[0];
-
-	uint32_t f;
-	std::array<uint32_t, 5> h = m_accHash;
-	std::array<uint32_t, 80> word;
-
-	for (int i = 0; i < 16; ++i)
-		word[i] = 
-		(block_[i * 4 + 0] << 24) | 
-		(block_[i * 4 + 1] << 16) | 
-		(block_[i * 4 + 2] <<  8) | 
-		(block_[i * 4 + 3] <<  0);
-
-	for (int i = 16; i < 80; ++i)
-		word[i] = rotl((
-			word[i -  3] ^ 
-			word[i -  8] ^ 
-			word[i - 14] ^ 
-			word[i - 16]), 1);
-
-	for (int run = 0; run < 80; ++run) 
-	{
-		if (run <= 19)
-			f = ((h[1] & h[2]) | ((~h[1]) & h[3])) + 0x5a827999;
-		else if (run <= 39)
-			f = (h[1] ^ h[2] ^ h[3]) + 0x6ed9eba1;
-		else if (run <= 59)
-			f = ((h[1] & h[2]) | (h[1] & h[3]) | (h[2] & h[3])) + 0x8f1bbcdc;
-		else
-			f = (h[1] ^ h[2] ^ h[3]) + 0xca62c1d6;
-
-		f += rotl(h[0], 5) + h[4] + word[run];
-		h[4] = h[3];
-		h[3] = h[2];
-		h[2] = rotl(h[1], 30);
-		h[1] = h[0];
-		h[0] = f;
-	}
-
-	for (uint32_t i = 0; i < m_accHash.size(); ++i)
-		m_accHash[i] += h[i];
+	static detail::SHA1BlocksFn const fn = detail::PickSHA1Blocks(); // SHA extensions when there are some.
+	fn(state, data, numBlocks);
 }
 
 inline void
 SHA1::Accumulate(uint8_t block)
 {
-	m_accumulator.push_back(block);
-
-	if (m_accumulator.size() == s_bufferNumBytes)
-	{
-		transformAcc();
-		m_accumulator.clear();
-	}
+	Accumulate(&block, 1);
 }
 
 inline void
@@ -263,35 +330,59 @@ SHA1::Accumulate(std::string s)
 inline void
 SHA1::Accumulate(char const * data, size_t sz)
 {
-	for (size_t s = 0; s < sz; s++)
-		Accumulate(reinterpret_cast<uint8_t const *>(data)[s]);
+	Accumulate(reinterpret_cast<uint8_t const *>(data), sz);
 }
 
 inline void
 SHA1::Accumulate(uint8_t const * data, size_t sz)
 {
-	for (size_t s = 0; s < sz; s++)
-		Accumulate(data[s]);
+	if (sz == 0)
+		return;
+
+	// Top up a partial block first.
+	if (m_accumulatorSize > 0)
+	{
+		size_t const n = std::min(sz, s_bufferNumBytes - m_accumulatorSize);
+		std::memcpy(&m_accumulator[m_accumulatorSize], data, n);
+		m_accumulatorSize += n;
+		data += n;
+		sz   -= n;
+
+		if (m_accumulatorSize < s_bufferNumBytes)
+			return;
+
+		transform(m_accHash.data(), m_accumulator.data(), 1);
+		m_accumulatorSize = 0;
+	}
+
+	// Whole blocks straight from the input.
+	if (size_t const numBlocks = sz / s_bufferNumBytes; numBlocks > 0)
+	{
+		transform(m_accHash.data(), data, numBlocks);
+		data += numBlocks * s_bufferNumBytes;
+		sz   -= numBlocks * s_bufferNumBytes;
+	}
+
+	if (sz > 0)
+		std::memcpy(m_accumulator.data(), data, sz);
+	m_accumulatorSize = sz;
 }
 
 
 inline std::array<uint32_t, 5> 
 SHA1::currentHash()
 {
-	size_t sz = m_accumulator.size();
-
-	if (sz == 0)
+	if (m_accumulatorSize == 0)
 		return m_accHash;
 
-	std::array<uint32_t, 5> lastHash = m_accHash;
-
-	m_accumulator.resize(s_bufferNumBytes, 0_u8);
-	transformAcc(); // sets --> m_accHash
-	m_accumulator.resize(sz);
+	// The partial block, zero padded. Doesn't change the running state, so more can be accumulated after.
+	std::array<uint8_t, 64> last = {};
+	std::memcpy(last.data(), m_accumulator.data(), m_accumulatorSize);
 
-	lastHash.swap(m_accHash);
+	std::array<uint32_t, 5> hash = m_accHash;
+	transform(hash.data(), last.data(), 1);
 
-	return lastHash; // <--- now the new hash
+	return hash;
 }
 
 inline void
@@ -34,9 +34,14 @@
 #pragma once
 
 #include <cstddef> // std::size_t, std::ptrdiff_t
+#include <cstdlib> // std::malloc, std::realloc, std::free
+#include <cstring> // std::memcpy
 #include <memory>  // std::allocator
+#include <new>     // std::bad_alloc
 #include <utility> // std::move
 
+#include "../HandyBase.hpp" // HANDY_NS::is_trivially_relocatable
+
 template <class T, size_t SmallSize>
 class small_vector_storage 
 {
@@ -48,7 +53,7 @@ protected:
 	      T * small_end()         { return small_begin() + SmallSize; }
 	const T * small_end()   const { return small_begin() + SmallSize; }
 
-	char m_storage[sizeof(T) * SmallSize];
+	alignas(T) char m_storage[sizeof(T) * SmallSize];
 private:
 	small_vector_storage(small_vector_storage<T, SmallSize> const &);
 	small_vector_storage<T, SmallSize> & operator=(small_vector_storage<T, SmallSize> const &);
@@ -103,7 +108,7 @@ public:
 		// If n is greater than the small size, allocate memory first. Otherwise we can use our small storage.
 		if (n > SmallSize)
 		{
-			m_begin = std::allocator<T>::allocate(n);
+			m_begin = allocate_storage(n);
 			m_capacity_end = m_begin + n;
 		}
 		m_end = m_begin + n;
@@ -119,7 +124,7 @@ public:
 		// If n is greater than the small size, allocate memory first. Otherwise we can use our small storage.
 		if (n > SmallSize)
 		{
-			m_begin = std::allocator<T>::allocate(n);
+			m_begin = allocate_storage(n);
 			m_capacity_end = m_begin + n;
 		}
 		m_end = m_begin + n;
@@ -161,7 +166,7 @@ public:
 		destroy_range(m_begin, m_end); // Destroy our objects
 
 		if (!is_small()) // Free our memory if not using the small storage
-			std::allocator<T>::deallocate(m_begin, capacity());
+			free_storage(m_begin, capacity());
 	}
 
 	// iterators:
@@ -188,9 +193,6 @@ public:
 	reference operator[](size_type n) { return m_begin[n]; }
 	const_reference operator[](size_type n) const { return m_begin[n]; }
 
-	//static T && mymove(T && t) { return static_cast<T&&>(t); }
-	static T & mymove(T & t) { return t; }
-
 	// 23.3.6.5, modifiers:
 	void push_back(T const & x)
 	{
@@ -198,74 +200,133 @@ public:
 		size_type const new_size = size() + 1;
 		if (new_size > capacity())
 		{
-			// Reallocate a bigger array, but make it still have size()
-			// elements, not size() + 1
+			// x may live in our own storage, so copy it before growing moves it.
+			T copy(x);
+			grow(std::max<size_type>(1u, 2 * capacity()));
+			::new (static_cast<void *>(m_end)) T(std::move(copy));
+		}
+		else
+		{
+			::new (static_cast<void *>(m_end)) T(x);
+		}
+
+		++m_end;
+	}
+
+	// Returns whether we're using our small storage
+	bool is_small() const { return m_begin == storage_base::small_begin(); }
+
+private:
+	T * m_begin;
+	T * m_end;
+	T * m_capacity_end;
+
+	// Trivially relocatable types move with memcpy. If malloc's alignment is enough for them, the heap
+	// storage comes from malloc too, so growing can realloc in place.
+	static constexpr bool relocate_by_memcpy  = HANDY_NS::is_trivially_relocatable_v<T>;
+	static constexpr bool relocate_by_realloc = relocate_by_memcpy && alignof(T) <= alignof(std::max_align_t);
+
+	T * allocate_storage(size_type n)
+	{
+		if constexpr (relocate_by_realloc)
+		{
+			void * p = std::malloc(n * sizeof(T));
+			if (!p)
+				throw std::bad_alloc();
+			return static_cast<T *>(p);
+		}
+		else
+		{
+			return std::allocator<T>::allocate(n);
+		}
+	}
+
+	void free_storage(T * p, size_type n)
+	{
+		if constexpr (relocate_by_realloc)
+			std::free(p);
+		else
+			std::allocator<T>::deallocate(p, n);
+	}
+
+	// Moves our elements into new storage with room for new_capacity of them.
+	void grow(size_type new_capacity)
+	{
+		size_type const old_size     = size();
+		size_type const old_capacity = capacity();
+		bool      const was_small    = is_small();
+
+		T * new_begin;
+
+		if constexpr (relocate_by_realloc)
+		{
+			if (!was_small)
+			{
+				void * p = std::realloc(static_cast<void *>(m_begin), new_capacity * sizeof(T));
+				if (!p)
+					throw std::bad_alloc();
+				new_begin = static_cast<T *>(p);
+			}
+			else
+			{
+				new_begin = allocate_storage(new_capacity);
+				if (old_size)
+					std::memcpy(static_cast<void *>(new_begin), static_cast<void const *>(m_begin), old_size * sizeof(T));
+			}
+		}
+		else if constexpr (relocate_by_memcpy)
+		{
+			new_begin = allocate_storage(new_capacity);
+			if (old_size)
+				std::memcpy(static_cast<void *>(new_begin), static_cast<void const *>(m_begin), old_size * sizeof(T));
 
-			// This could throw bad_alloc
-			size_type const new_capacity = std::max<size_type>(1u, 2 * capacity());
-			T * new_begin = std::allocator<T>::allocate(new_capacity);
+			if (!was_small)
+				free_storage(m_begin, old_capacity);
+		}
+		else
+		{
+			new_begin = allocate_storage(new_capacity);
 
-			// Copy- or move-construct elements. If the constructor throws,
-			// we'll delete our new array and rethrow.
-			// After constructing the new element, we destroy the old one.
-			try 
+			// Move-construct elements (copy if the move could throw). If a constructor throws,
+			// we'll destroy what we made, delete our new array and rethrow.
+			T * new_elem = new_begin;
+			try
 			{
-				T * old_elem = m_begin;
-				for (T * new_elem = new_begin; old_elem != m_end; ++new_elem, ++old_elem)
-				{
-					std::allocator<T>::construct(new_elem, mymove(*old_elem));
-					std::allocator<T>::destroy(old_elem);
-				}
+				for (T * old_elem = m_begin; old_elem != m_end; ++new_elem, ++old_elem)
+					::new (static_cast<void *>(new_elem)) T(std::move_if_noexcept(*old_elem));
 			}
 			catch (...)
 			{
-				std::allocator<T>::deallocate(new_begin, new_capacity);
+				destroy_range(new_begin, new_elem);
+				free_storage(new_begin, new_capacity);
 				throw;
 			}
 
-			// Now use the new array and free the old one
-			T * old_begin = m_begin;
-
-			size_type const old_size     = size();
-			size_type const old_capacity = capacity();
-
-			bool const was_small = is_small();
-
-			m_begin        = new_begin;
-			m_end          = new_begin + old_size;
-			m_capacity_end = new_begin + new_capacity;
+			destroy_range(m_begin, m_end);
 
 			// Only free memory if it's not from our small backing storage
 			if (!was_small)
-				std::allocator<T>::deallocate(old_begin, old_capacity);
+				free_storage(m_begin, old_capacity);
 		}
 
-		// Now just construct the new element
-		std::allocator<T>::construct(m_end, x);
-		++m_end;
+		m_begin        = new_begin;
+		m_end          = new_begin + old_size;
+		m_capacity_end = new_begin + new_capacity;
 	}
 
-	// Returns whether we're using our small storage
-	bool is_small() const { return m_begin == storage_base::small_begin(); }
-
-private:
-	T * m_begin;
-	T * m_end;
-	T * m_capacity_end;
-
 	// Initializes the range [first, last) to value. Doesn't destruct the
 	// range because it assumes that no objects have been constructed there.
 	void uninitialized_fill(T * first, T * last, T const & value)
 	{
 		for (; first != last; ++first)
-			std::allocator<T>::construct(first, value);
+			::new (static_cast<void *>(first)) T(value);
 	}
 
 	// Destroys the objects in the range [first, last)
 	void destroy_range(T * first, T * last)
 	{
 		for (; first != last; ++first)
-			std::allocator<T>::destroy(first);
+			first->~T();
 	}
 
 	// Range construct for multi-pass iterators
@@ -276,7 +337,7 @@ private:
 		size_type const n = std::distance(first, last);
 		if (n > SmallSize)
 		{
-			m_begin = std::allocator<T>::allocate(n);
+			m_begin = allocate_storage(n);
 			m_capacity_end = m_begin + n;
 		}
 		m_end = m_begin + n;
@@ -284,7 +345,7 @@ private:
 		// Copy construct the range
 		for (T * elem = m_begin; first != last; ++first, ++elem)
 		{
-			std::allocator<T>::construct(elem, *first);
+			::new (static_cast<void *>(elem)) T(*first);
 		}
 	}
 
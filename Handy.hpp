@@ -1,8 +1,14 @@
 #pragma once
 
 #include "HandyBase.hpp"
+#include "HandyCache.hpp"
+#include "HandyChunker.hpp"
 #include "HandyCompat.hpp"
+#include "HandyConcurrentVector.hpp"
 #include "HandyEncoding.hpp"
+#include "HandyFilter.hpp"
+#include "HandyFlatHash.hpp"
+#include "HandyFlatMap.hpp"
 #include "HandyGuid.hpp"
 #include "HandyHash.hpp"
 #include "HandyLoader.hpp"
@@ -11,12 +17,16 @@
 #include "HandyConsole.hpp"
 #include "HandyRange.hpp"
 #include "HandyResult.hpp"
+#include "HandyRingBuffer.hpp"
 #include "HandySerDe.hpp"
+#include "HandySlotMap.hpp"
+#include "HandySmallString.hpp"
 #include "HandyFile.hpp"
 #include "HandyMMFile.hpp"
 #include "HandyString.hpp"
 #include "HandySystemInfo.hpp"
 #include "HandyThreadUtils.hpp"
+#include "HandyTreeHash.hpp"
 #include "HandyTryGet.hpp"
 #include "HandyUtils.hpp"
 
@@ -610,7 +610,11 @@ using namespace std::literals::string_literals;
 	#define DEPRECATED   __attribute__((deprecated))
 	#define FPURE        __attribute__((pure))
 	#define FCONST       __attribute__((const))
+	#define TARGET_ISA(x) __attribute__((target(x)))
 
+	// TARGET_ISA("avx2") lets one function use instructions the rest of the build doesn't assume, 
+	// for code that is picked at runtime (see CPUInfoCached). MSVC needs no flag for intrinsics.
+	//
 	// __attribute__((pure)) function attribute
 	// Many functions have no effects except to return a value, and
 	// their return value depends only on the parameters and global 
@@ -660,6 +664,7 @@ using namespace std::literals::string_literals;
 	#define DEPRECATED   
 	#define FPURE
 	#define FCONST
+	#define TARGET_ISA(x)
 	#define CDECL       __cdecl
 	#define CLRCALL     __clrcall
 	#define STDCALL     __stdcall
@@ -688,6 +693,7 @@ using namespace std::literals::string_literals;
 	#define DEPRECATED   
 	#define FPURE
 	#define FCONST
+	#define TARGET_ISA(x)
 	#define CDECL
 	#define CLRCALL
 	#define STDCALL
@@ -1244,6 +1250,24 @@ namespace HANDY_NS {
 	/// Forces a cast from rvalue to lvalue.
 	template<class T> T & unmove(T && t) { return t; } 
 
+	///-----------------------------------------------
+	/// True if moving a T to a new address, and not destructing the original, can be done with memcpy. 
+	/// Containers use this to grow with memcpy/realloc instead of moving elements one at a time.
+	/// Trivially copyable types are, anything else has to opt in by specializing this.
+	template <typename T> struct is_trivially_relocatable : std::is_trivially_copyable<T> { };
+	template <typename T> inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+	/// libc++ and MSVC (without iterator debugging) strings never point into themselves. libstdc++ strings do.
+	#if defined _LIBCPP_VERSION || (defined IS_MSVC && _ITERATOR_DEBUG_LEVEL == 0)
+		template <typename C, typename Tr, typename A> struct is_trivially_relocatable<std::basic_string<C, Tr, A>> : std::true_type { };
+	#endif
+
+	/// Opts a type in, for types that only hold values but aren't trivially copyable (e.g. a user-provided copy ctor).
+	/// Use at global scope, like MAKE_HASHABLE.
+	#define MAKE_TRIVIALLY_RELOCATABLE(type) \
+		namespace HANDY_NS { template <> struct is_trivially_relocatable<type> : std::true_type { }; }
+	///-----------------------------------------------
+
 
 	/// Byte swap an integer, auto sized.
 	template <typename T>
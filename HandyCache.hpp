@@ -0,0 +1,455 @@
+
+/// ========================================================================
+/// UNLICENSE
+///
+/// This is free and unencumbered software released into the public domain.
+/// Anyone is free to copy, modify, publish, use, compile, sell, or
+/// distribute this software, either in source code form or as a compiled
+/// binary, for any purpose, commercial or non-commercial, and by any
+/// means.
+///
+/// In jurisdictions that recognize copyright laws, the author or authors
+/// of this software dedicate any and all copyright interest in the
+/// software to the public domain. We make this dedication for the benefit
+/// of the public at large and to the detriment of our heirs and
+/// successors. We intend this dedication to be an overt act of
+/// relinquishment in perpetuity of all present and future rights to this
+/// software under copyright law.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+/// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+/// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+/// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+/// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/// OTHER DEALINGS IN THE SOFTWARE.
+///
+/// For more information, please refer to <http://unlicense.org/>
+/// ========================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "HandyBase.hpp"
+#include "HandyFlatHash.hpp"
+
+namespace HANDY_NS {
+
+	/// Which entry a Cache evicts when it is over capacity.
+	enum class CachePolicy
+	{
+		LRU,   /// The least recently used. Every hit moves the entry to the front of the list.
+		Clock, /// Second chance: a hit only sets a flag, and the clock hand skips (and clears) flagged
+		       /// entries. Close to LRU, but a hit writes one bool, rather than relinking two nodes.
+	};
+
+	///-----------------------------------------------
+	/// Cache
+	/// Bounded key-value cache. Entries live in one vector of nodes, threaded on an intrusive circular
+	/// list (indices, not pointers), and a FlatHashMap maps keys to node indices. Freed nodes are
+	/// reused, so a cache at capacity doesn't allocate.
+	///
+	/// Capacity is in charge units: each insert() says what its entry costs (1 by default), and the
+	/// cache evicts until the total fits. Leave the charges at 1 to bound the number of entries, or
+	/// pass sizes to bound the bytes. The entry just inserted is never evicted by its own insert, even
+	/// if it alone is over capacity.
+	///
+	/// The eviction callback sees each entry evicted for capacity (not erase() or clear()), just
+	/// before it is destroyed, and may move the value out. It must not call back into the cache.
+	///
+	/// Pointers returned by get() and peek() are invalidated by the next insert() or erase().
+	template <typename TKey, typename TValue, CachePolicy Policy = CachePolicy::LRU, typename THash = FlatHash<TKey>, typename TEq = FlatEq<TKey>>
+	class Cache
+	{
+	public:
+		using key_type         = TKey;
+		using mapped_type      = TValue;
+		using EvictionCallback = std::function<void(TKey const & key, TValue & value)>;
+
+	private:
+		static constexpr uint32_t npos = ~uint32_t(0);
+
+		struct Node
+		{
+			std::optional<std::pair<TKey, TValue>> Entry;
+
+			size_t   Charge     = 0;
+			uint32_t Prev       = npos;
+			uint32_t Next       = npos; /// Also links the free list.
+			bool     Referenced = false;
+		};
+
+		std::vector<Node>                       m_nodes;
+		FlatHashMap<TKey, uint32_t, THash, TEq> m_index;
+
+		uint32_t m_head = npos; /// LRU: most recently used. Clock: the hand.
+		uint32_t m_free = npos;
+
+		size_t m_capacity;
+		size_t m_charge = 0;
+
+		EvictionCallback m_onEvict;
+
+		uint64_t m_hits      = 0;
+		uint64_t m_misses    = 0;
+		uint64_t m_evictions = 0;
+
+		void unlink(uint32_t i)
+		{
+			Node & n = m_nodes[i];
+
+			if (n.Next == i)
+			{
+				m_head = npos;
+			}
+			else
+			{
+				m_nodes[n.Prev].Next = n.Next;
+				m_nodes[n.Next].Prev = n.Prev;
+
+				if (m_head == i)
+					m_head = n.Next;
+			}
+		}
+
+		/// Links i in just behind the head, which is the back of the list, or (for Clock) the last
+		/// position the hand reaches.
+		void linkBack(uint32_t i)
+		{
+			Node & n = m_nodes[i];
+
+			if (m_head == npos)
+			{
+				n.Prev = n.Next = m_head = i;
+				return;
+			}
+
+			uint32_t const tail = m_nodes[m_head].Prev;
+
+			n.Prev = tail;
+			n.Next = m_head;
+			m_nodes[tail].Next   = i;
+			m_nodes[m_head].Prev = i;
+		}
+
+		void linkNew(uint32_t i)
+		{
+			linkBack(i);
+
+			if constexpr (Policy == CachePolicy::LRU)
+				m_head = i;
+		}
+
+		void touch(uint32_t i)
+		{
+			if constexpr (Policy == CachePolicy::LRU)
+			{
+				if (i != m_head)
+				{
+					unlink(i);
+					linkBack(i);
+					m_head = i;
+				}
+			}
+			else
+			{
+				m_nodes[i].Referenced = true;
+			}
+		}
+
+		uint32_t victim()
+		{
+			if constexpr (Policy == CachePolicy::LRU)
+			{
+				return m_nodes[m_head].Prev;
+			}
+			else
+			{
+				while (m_nodes[m_head].Referenced)
+				{
+					m_nodes[m_head].Referenced = false;
+					m_head = m_nodes[m_head].Next;
+				}
+				return m_head;
+			}
+		}
+
+		uint32_t allocNode()
+		{
+			if (m_free != npos)
+			{
+				uint32_t const i = m_free;
+				m_free = m_nodes[i].Next;
+				return i;
+			}
+
+			m_nodes.emplace_back();
+			return uint32_t(m_nodes.size() - 1);
+		}
+
+		void removeNode(uint32_t i, bool evicted)
+		{
+			Node & n = m_nodes[i];
+
+			if (evicted)
+			{
+				m_evictions++;
+				if (m_onEvict)
+					m_onEvict(n.Entry->first, n.Entry->second);
+			}
+
+			m_index.erase(n.Entry->first);
+			unlink(i);
+
+			m_charge -= n.Charge;
+			n.Entry.reset();
+			n.Referenced = false;
+			n.Next       = m_free;
+			m_free       = i;
+		}
+
+		/// Evicts until the charges fit, but never keep.
+		void evictToFit(uint32_t keep)
+		{
+			while (m_charge > m_capacity && m_head != npos)
+			{
+				uint32_t const v = victim();
+
+				if (v == keep)
+				{
+					if (m_index.size() == 1)
+						break;
+
+					/// Only reachable with Clock: every other entry was flagged, so go round once more.
+					m_head = m_nodes[v].Next;
+					continue;
+				}
+
+				removeNode(v, true);
+			}
+		}
+
+	public:
+		explicit Cache(size_t capacity) : m_capacity(capacity) { }
+
+		void set_eviction_callback(EvictionCallback onEvict) { m_onEvict = std::move(onEvict); }
+
+		/// Returns the value and marks it used, or nullptr.
+		TValue * get(TKey const & key)
+		{
+			auto it = m_index.find(key);
+			if (it == m_index.end())
+			{
+				m_misses++;
+				return nullptr;
+			}
+
+			m_hits++;
+			touch(it->second);
+			return &m_nodes[it->second].Entry->second;
+		}
+
+		/// Returns the value without marking it used, or counting a hit or miss.
+		TValue * peek(TKey const & key)
+		{
+			auto it = m_index.find(key);
+			return it == m_index.end() ? nullptr : &m_nodes[it->second].Entry->second;
+		}
+
+		bool contains(TKey const & key) const { return m_index.contains(key); }
+
+		/// Inserts or replaces the value for key, marks it used, then evicts as needed.
+		TValue & insert(TKey const & key, TValue value, size_t charge = 1)
+		{
+			uint32_t i;
+
+			auto it = m_index.find(key);
+			if (it != m_index.end())
+			{
+				i = it->second;
+
+				Node & n = m_nodes[i];
+				m_charge = m_charge - n.Charge + charge;
+				n.Charge = charge;
+				n.Entry->second = std::move(value);
+				touch(i);
+			}
+			else
+			{
+				i = allocNode();
+
+				Node & n = m_nodes[i];
+				n.Entry.emplace(key, std::move(value));
+				n.Charge = charge;
+				m_index.try_emplace(key, i);
+				linkNew(i);
+				m_charge += charge;
+			}
+
+			evictToFit(i);
+			return m_nodes[i].Entry->second;
+		}
+
+		/// Returns true if key was present. No eviction callback.
+		bool erase(TKey const & key)
+		{
+			auto it = m_index.find(key);
+			if (it == m_index.end())
+				return false;
+
+			removeNode(it->second, false);
+			return true;
+		}
+
+		/// No eviction callbacks.
+		void clear()
+		{
+			m_nodes.clear();
+			m_index.clear();
+			m_head   = npos;
+			m_free   = npos;
+			m_charge = 0;
+		}
+
+		/// Evicts down to the new capacity right away.
+		void set_capacity(size_t capacity)
+		{
+			m_capacity = capacity;
+			evictToFit(npos);
+		}
+
+		size_t size()     const { return m_index.size(); }
+		bool   empty()    const { return m_index.empty(); }
+		size_t charge()   const { return m_charge; }
+		size_t capacity() const { return m_capacity; }
+
+		uint64_t hits()      const { return m_hits; }
+		uint64_t misses()    const { return m_misses; }
+		uint64_t evictions() const { return m_evictions; }
+
+		/// Visits every entry as fn(key, value), from most to least recently used (LRU), or in clock
+		/// order from the hand (Clock). Doesn't mark anything used.
+		template <typename Fn>
+		void for_each(Fn && fn)
+		{
+			if (m_head == npos)
+				return;
+
+			uint32_t i = m_head;
+			do
+			{
+				fn(m_nodes[i].Entry->first, m_nodes[i].Entry->second);
+				i = m_nodes[i].Next;
+			} while (i != m_head);
+		}
+	};
+
+	template <typename TKey, typename TValue, typename THash = FlatHash<TKey>, typename TEq = FlatEq<TKey>>
+	using LRUCache = Cache<TKey, TValue, CachePolicy::LRU, THash, TEq>;
+
+	template <typename TKey, typename TValue, typename THash = FlatHash<TKey>, typename TEq = FlatEq<TKey>>
+	using ClockCache = Cache<TKey, TValue, CachePolicy::Clock, THash, TEq>;
+
+	///-----------------------------------------------
+	/// Sharded Cache
+	/// Thread-safe Cache, split into NumShards independent caches by key hash, each with its own mutex
+	/// and 1/NumShards of the capacity. Threads only contend when they hit the same shard. Values are
+	/// returned by copy, since a pointer into a shard would outlive its lock. Eviction callbacks run
+	/// under the shard's lock.
+	template <typename TKey, typename TValue, CachePolicy Policy = CachePolicy::LRU, size_t NumShards = 16, typename THash = FlatHash<TKey>, typename TEq = FlatEq<TKey>>
+	class ShardedCache
+	{
+		static_assert(NumShards > 0, "ShardedCache needs at least one shard.");
+
+		using ShardCache = Cache<TKey, TValue, Policy, THash, TEq>;
+
+		struct alignas(64) Shard
+		{
+			std::mutex Mutex;
+			ShardCache Entries;
+
+			explicit Shard(size_t capacity) : Entries(capacity) { }
+		};
+
+		std::vector<std::unique_ptr<Shard>> m_shards;
+
+		/// The high bits, since FlatHashMap uses the low ones inside each shard.
+		Shard & shardFor(TKey const & key) const
+		{
+			return *m_shards[(uint64_t(THash()(key)) >> 40) % NumShards];
+		}
+
+	public:
+		using EvictionCallback = typename ShardCache::EvictionCallback;
+
+		COPY_ASSIGN_MOVE_CTOR(ShardedCache, delete, delete, delete)
+
+		explicit ShardedCache(size_t capacity)
+		{
+			m_shards.reserve(NumShards);
+			for (size_t s = 0; s < NumShards; s++)
+				m_shards.push_back(std::make_unique<Shard>((capacity + NumShards - 1) / NumShards));
+		}
+
+		void set_eviction_callback(EvictionCallback const & onEvict)
+		{
+			for (auto & shard : m_shards)
+				Locked(shard->Mutex) { shard->Entries.set_eviction_callback(onEvict); }
+		}
+
+		std::optional<TValue> get(TKey const & key)
+		{
+			Shard & shard = shardFor(key);
+			Locked(shard.Mutex)
+			{
+				if (TValue * v = shard.Entries.get(key))
+					return *v;
+			}
+			return std::nullopt;
+		}
+
+		void insert(TKey const & key, TValue value, size_t charge = 1)
+		{
+			Shard & shard = shardFor(key);
+			Locked(shard.Mutex) { shard.Entries.insert(key, std::move(value), charge); }
+		}
+
+		bool erase(TKey const & key)
+		{
+			Shard & shard = shardFor(key);
+			Locked(shard.Mutex) { return shard.Entries.erase(key); }
+			return false;
+		}
+
+		void clear()
+		{
+			for (auto & shard : m_shards)
+				Locked(shard->Mutex) { shard->Entries.clear(); }
+		}
+
+		/// Sums over the shards, each read under its own lock, so only a snapshot under concurrent use.
+		size_t   size()      const { return sum([](ShardCache const & c) { return uint64_t(c.size());   }); }
+		size_t   charge()    const { return sum([](ShardCache const & c) { return uint64_t(c.charge()); }); }
+		uint64_t hits()      const { return sum([](ShardCache const & c) { return c.hits();      }); }
+		uint64_t misses()    const { return sum([](ShardCache const & c) { return c.misses();    }); }
+		uint64_t evictions() const { return sum([](ShardCache const & c) { return c.evictions(); }); }
+
+	private:
+		template <typename Fn>
+		uint64_t sum(Fn && fn) const
+		{
+			uint64_t total = 0;
+			for (auto & shard : m_shards)
+				Locked(shard->Mutex) { total += fn(shard->Entries); }
+			return total;
+		}
+	};
+}
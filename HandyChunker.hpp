@@ -0,0 +1,310 @@
+
+/// ========================================================================
+/// UNLICENSE
+///
+/// This is free and unencumbered software released into the public domain.
+/// Anyone is free to copy, modify, publish, use, compile, sell, or
+/// distribute this software, either in source code form or as a compiled
+/// binary, for any purpose, commercial or non-commercial, and by any
+/// means.
+///
+/// In jurisdictions that recognize copyright laws, the author or authors
+/// of this software dedicate any and all copyright interest in the
+/// software to the public domain. We make this dedication for the benefit
+/// of the public at large and to the detriment of our heirs and
+/// successors. We intend this dedication to be an overt act of
+/// relinquishment in perpetuity of all present and future rights to this
+/// software under copyright law.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+/// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+/// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+/// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+/// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/// OTHER DEALINGS IN THE SOFTWARE.
+///
+/// For more information, please refer to <http://unlicense.org/>
+/// ========================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "HandyBase.hpp"
+#include "HandyCompat.hpp"
+#include "HandyHash.hpp"
+#include "HandyMMFile.hpp"
+#include "HandyTreeHash.hpp"
+
+namespace HANDY_NS {
+
+	namespace detail {
+
+		/// 256 random 64-bit words for the Gear hash, from splitmix64. Changing these moves every chunk
+		/// boundary, so they are fixed forever.
+		struct GearTable { uint64_t Values[256]; };
+
+		constexpr GearTable MakeGearTable()
+		{
+			GearTable t{};
+			uint64_t  x = 0x48616E6479434443ULL; /// "HandyCDC"
+
+			for (int i = 0; i < 256; i++)
+			{
+				x += 0x9E3779B97F4A7C15ULL;
+				uint64_t z = x;
+				z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+				z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+				t.Values[i] = z ^ (z >> 31);
+			}
+
+			return t;
+		}
+
+		inline constexpr GearTable Gear = MakeGearTable();
+	}
+
+	///-----------------------------------------------
+	/// FastCDC
+	/// Content-defined chunking: cuts data where a rolling Gear hash of the last 64 bytes hits a mask,
+	/// so boundaries follow the content rather than the offset. Inserting or deleting a byte only
+	/// changes the chunk(s) around it, and later boundaries fall back into step with the old ones. With
+	/// fixed size blocks, every block after the edit would change.
+	///
+	/// Chunks are never shorter than MinSize (except the last), nor longer than MaxSize. Between MinSize
+	/// and AvgSize the mask is 2 bits stricter and past AvgSize 2 bits looser ("normalized chunking"),
+	/// which pulls sizes in around AvgSize. The first MinSize bytes of a chunk aren't hashed at all.
+	///
+	/// Each chunk comes with a digest to key a dedup store with: SHA3-256 by default, or XXH3-128 when the
+	/// store can live with a non-cryptographic key (collisions are possible if an adversary picks the data).
+	///
+	/// Split/ForEachChunk take data that's all in memory (or mapped, see SplitFile). Stream takes it
+	/// piecewise and gives the exact same chunks however the input is split up.
+	class FastCDC
+	{
+	public:
+		static constexpr uint64_t DefaultMinSize =  16_KiB;
+		static constexpr uint64_t DefaultAvgSize =  64_KiB;
+		static constexpr uint64_t DefaultMaxSize = 256_KiB;
+
+		struct Chunk
+		{
+			uint64_t                Offset = 0; /// From the start of the input.
+			uint64_t                Size   = 0;
+			Hash::TreeHash::Digest  Digest = {}; /// XXH3 only fills the first 16 bytes, the rest stay 0.
+
+			template <class SerialOp> void serial(SerialOp & ser) { ser(Offset); ser(Size); ser(Digest); }
+		};
+
+	private:
+		size_t                  m_minSize;
+		size_t                  m_avgSize;
+		size_t                  m_maxSize;
+		uint64_t                m_maskS; /// Before AvgSize: harder to hit.
+		uint64_t                m_maskL; /// After AvgSize: easier.
+		Hash::TreeHashAlgorithm m_algorithm;
+
+		/// Top bits, since those depend on the most bytes (the hash shifts left once per byte).
+		static constexpr uint64_t topBits(uint32_t n) { return n == 0 ? 0 : ~0_u64 << (64 - n); }
+
+		template <typename TFn>
+		void emit(uint8_t const * data, size_t size, uint64_t offset, TFn & onChunk) const
+		{
+			Chunk c;
+			c.Offset = offset;
+			c.Size   = size;
+
+			if (m_algorithm == Hash::TreeHashAlgorithm::SHA3)
+			{
+				Hash::SHA3<Hash::SHA3Bits::Bits256> h;
+				h.Add(data, size);
+				c.Digest = h.Get();
+			}
+			else
+			{
+				Hash::Digest128 const r = Hash::XXH3::Hash128(data, size);
+				std::memcpy(c.Digest.data(),     &r.Low64,  8);
+				std::memcpy(c.Digest.data() + 8, &r.High64, 8);
+			}
+
+			onChunk(c, std::span<std::byte const>(reinterpret_cast<std::byte const *>(data), size));
+		}
+
+	public:
+		FastCDC(uint64_t                minSize   = DefaultMinSize,
+		        uint64_t                avgSize   = DefaultAvgSize,
+		        uint64_t                maxSize   = DefaultMaxSize,
+		        Hash::TreeHashAlgorithm algorithm = Hash::TreeHashAlgorithm::SHA3)
+			: m_minSize(size_t(minSize))
+			, m_avgSize(size_t(avgSize))
+			, m_maxSize(size_t(maxSize))
+			, m_algorithm(algorithm)
+		{
+			if (minSize < 64 || minSize >= avgSize || avgSize >= maxSize)
+				throw std::invalid_argument("FastCDC - sizes must be 64 <= min < avg < max.");
+
+			uint32_t bits = 0;
+			while ((2_u64 << bits) <= avgSize)
+				bits++;
+
+			m_maskS = topBits(FastMin(bits + 2, 64u));
+			m_maskL = topBits(bits > 2 ? bits - 2 : 1);
+		}
+
+		uint64_t MinSize() const { return m_minSize; }
+		uint64_t AvgSize() const { return m_avgSize; }
+		uint64_t MaxSize() const { return m_maxSize; }
+
+		Hash::TreeHashAlgorithm Algorithm() const { return m_algorithm; }
+
+		/// Length of the chunk at the start of data, taking the end of data as the end of the input.
+		size_t Cut(uint8_t const * data, size_t size) const
+		{
+			if (size <= m_minSize)
+				return size;
+
+			size_t const n      = FastMin(size, m_maxSize);
+			size_t const normal = FastMin(n, m_avgSize);
+			uint64_t     h      = 0;
+			size_t       i      = m_minSize;
+
+			for (; i < normal; i++)
+			{
+				h = (h << 1) + detail::Gear.Values[data[i]];
+				if (!(h & m_maskS))
+					return i + 1;
+			}
+
+			for (; i < n; i++)
+			{
+				h = (h << 1) + detail::Gear.Values[data[i]];
+				if (!(h & m_maskL))
+					return i + 1;
+			}
+
+			return n;
+		}
+
+		/// Calls onChunk(Chunk const &, std::span<std::byte const> chunkData) for each chunk, in order.
+		template <typename TFn>
+		void ForEachChunk(std::span<std::byte const> data, TFn && onChunk) const
+		{
+			uint8_t const * p    = reinterpret_cast<uint8_t const *>(data.data());
+			size_t          left = data.size();
+
+			while (left > 0)
+			{
+				size_t const c = Cut(p, left);
+				emit(p, c, uint64_t(p - reinterpret_cast<uint8_t const *>(data.data())), onChunk);
+				p    += c;
+				left -= c;
+			}
+		}
+
+		std::vector<Chunk> Split(std::span<std::byte const> data) const
+		{
+			std::vector<Chunk> chunks;
+			chunks.reserve(data.size() / m_avgSize + 1);
+			ForEachChunk(data, [&chunks](Chunk const & c, std::span<std::byte const>) { chunks.push_back(c); });
+			return chunks;
+		}
+
+		/// Split over a read-only mapping of the file. Empty if the file can't be opened or mapped.
+		std::optional<std::vector<Chunk>> SplitFile(std::filesystem::path const & path) const
+		{
+			MMFileReadOnly file;
+			file.open(path.string().c_str());
+
+			if (!file.is_open() || (file.file_size() > 0 && !file.data()))
+				return std::optional<std::vector<Chunk>>();
+
+			return Split(std::span<std::byte const>(reinterpret_cast<std::byte const *>(file.data()), file.mapped_size()));
+		}
+
+		class Stream;
+	};
+
+	///-----------------------------------------------
+	/// Chunks input that arrives piecewise. Holds back at most MaxSize bytes, since a boundary can't
+	/// be decided until MaxSize bytes past the last one are in (or the input has ended).
+	class FastCDC::Stream
+	{
+		FastCDC              m_cdc;
+		std::vector<uint8_t> m_pending;
+		size_t               m_read   = 0; /// m_pending before this is already emitted, and goes at the next refill.
+		uint64_t             m_offset = 0; /// Of m_pending[m_read] in the whole input.
+
+	public:
+		explicit Stream(FastCDC const & cdc) : m_cdc(cdc) { m_pending.reserve(2 * size_t(cdc.MaxSize())); }
+
+		/// Calls onChunk like ForEachChunk, for every chunk that is now certain.
+		template <typename TFn>
+		void Add(void const * input, size_t size, TFn && onChunk)
+		{
+			uint8_t const * data = (uint8_t const *)input;
+			size_t const    max  = m_cdc.m_maxSize;
+
+			/// Top up the held back bytes with up to MaxSize more, cut while there's a full window, repeat.
+			/// The emitted bytes are dropped once per refill rather than once per chunk.
+			while (m_read < m_pending.size())
+			{
+				if (size == 0)
+					return;
+
+				if (m_read > 0)
+				{
+					m_pending.erase(m_pending.begin(), m_pending.begin() + m_read);
+					m_read = 0;
+				}
+
+				size_t const take = FastMin(size, max);
+				m_pending.insert(m_pending.end(), data, data + take);
+				data += take;
+				size -= take;
+
+				while (m_pending.size() - m_read >= max)
+				{
+					size_t const c = m_cdc.Cut(m_pending.data() + m_read, max);
+					m_cdc.emit(m_pending.data() + m_read, c, m_offset, onChunk);
+					m_read   += c;
+					m_offset += c;
+				}
+			}
+
+			/// Nothing held back: cut straight from the input while there's a full window.
+			while (size >= max)
+			{
+				size_t const c = m_cdc.Cut(data, size);
+				m_cdc.emit(data, c, m_offset, onChunk);
+				data     += c;
+				size     -= c;
+				m_offset += c;
+			}
+
+			m_pending.assign(data, data + size);
+			m_read = 0;
+		}
+
+		/// Ends the input, emitting whatever is left.
+		template <typename TFn>
+		void Finish(TFn && onChunk)
+		{
+			while (m_read < m_pending.size())
+			{
+				size_t const c = m_cdc.Cut(m_pending.data() + m_read, m_pending.size() - m_read);
+				m_cdc.emit(m_pending.data() + m_read, c, m_offset, onChunk);
+				m_read   += c;
+				m_offset += c;
+			}
+
+			m_pending.clear();
+			m_read = 0;
+		}
+	};
+}
@@ -0,0 +1,304 @@
+
+/// ========================================================================
+/// UNLICENSE
+///
+/// This is free and unencumbered software released into the public domain.
+/// Anyone is free to copy, modify, publish, use, compile, sell, or
+/// distribute this software, either in source code form or as a compiled
+/// binary, for any purpose, commercial or non-commercial, and by any
+/// means.
+///
+/// In jurisdictions that recognize copyright laws, the author or authors
+/// of this software dedicate any and all copyright interest in the
+/// software to the public domain. We make this dedication for the benefit
+/// of the public at large and to the detriment of our heirs and
+/// successors. We intend this dedication to be an overt act of
+/// relinquishment in perpetuity of all present and future rights to this
+/// software under copyright law.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+/// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+/// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+/// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+/// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/// OTHER DEALINGS IN THE SOFTWARE.
+///
+/// For more information, please refer to <http://unlicense.org/>
+/// ========================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "HandyBase.hpp"
+#include "HandyUtils.hpp"
+
+namespace HANDY_NS {
+
+	///-----------------------------------------------
+	/// Concurrent Vector
+	/// Append-only vector that any number of threads can push_back into at once, without locks. Each
+	/// push reserves its index with one fetch_add, then constructs the element in place. Storage is a
+	/// fixed table of segments, each twice the size of the last, so elements never move, and growing
+	/// is a single compare-exchange on the (rare) push that first lands in a new segment.
+	///
+	/// Meant as the output of parallel jobs: instead of a vector per job plus a merge, every job
+	/// pushes into one ConcurrentVector, and once the ThreadPool is waited on, [0, size()) is all there.
+	///
+	/// Element i is published (safe to read from any thread) once is_published(i) is true, or once the
+	/// thread that pushed it has been joined/waited on. operator[] doesn't check; at() does.
+	/// clear() and destruction must not race with anything.
+	template <typename T>
+	class ConcurrentVector
+	{
+		static constexpr size_t MaxSegments = 64;
+		static constexpr size_t ItemAlign   = alignof(T) > 64 ? alignof(T) : 64;
+
+		/// Each segment is one allocation: the published bits, then the elements.
+		struct SegmentInfo
+		{
+			size_t Capacity;
+			size_t ReadyWords;
+			size_t ItemsOffset;
+		};
+
+		size_t                           m_firstLog2;
+		std::atomic<size_t>              m_reserved { 0 };
+		std::atomic<std::byte *>         m_segments[MaxSegments] = {};
+
+		static FORCEINLINE size_t floorLog2(uint64_t n)
+		{
+			assert(n);
+			#if defined IS_MSVC
+				unsigned long result = 0;
+				_BitScanReverse64(&result, n);
+				return size_t(result);
+			#else
+				return size_t(63 - __builtin_clzll(n));
+			#endif
+		}
+
+		SegmentInfo segmentInfo(size_t seg) const
+		{
+			SegmentInfo info;
+			info.Capacity    = size_t(1) << (m_firstLog2 + seg);
+			info.ReadyWords  = (info.Capacity + 63) / 64;
+			info.ItemsOffset = (info.ReadyWords * sizeof(uint64_t) + ItemAlign - 1) / ItemAlign * ItemAlign;
+			return info;
+		}
+
+		/// Segment s holds indices [F * (2^s - 1), F * (2^(s+1) - 1)), for first segment size F.
+		FORCEINLINE void locate(size_t index, size_t & seg, size_t & offset) const
+		{
+			seg    = floorLog2((index >> m_firstLog2) + 1);
+			offset = index - (((size_t(1) << seg) - 1) << m_firstLog2);
+		}
+
+		static FORCEINLINE std::atomic<uint64_t> * readyBits(std::byte * base) { return reinterpret_cast<std::atomic<uint64_t> *>(base); }
+
+		FORCEINLINE T * items(std::byte * base, size_t seg) const { return reinterpret_cast<T *>(base + segmentInfo(seg).ItemsOffset); }
+
+		std::byte * segment(size_t seg)
+		{
+			std::byte * base = m_segments[seg].load(std::memory_order_acquire);
+			if (base)
+				return base;
+
+			if (seg >= MaxSegments - m_firstLog2)
+				throw std::length_error("ConcurrentVector is full.");
+
+			SegmentInfo const info  = segmentInfo(seg);
+			std::byte *       fresh = static_cast<std::byte *>(::operator new(info.ItemsOffset + info.Capacity * sizeof(T), std::align_val_t(ItemAlign)));
+
+			for (size_t w = 0; w < info.ReadyWords; w++)
+				new (readyBits(fresh) + w) std::atomic<uint64_t>(0);
+
+			/// Someone else may have got there first. Then theirs wins, and ours goes back.
+			if (m_segments[seg].compare_exchange_strong(base, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+				return fresh;
+
+			::operator delete(fresh, std::align_val_t(ItemAlign));
+			return base;
+		}
+
+		template <typename... Args>
+		size_t emplaceAt(size_t index, Args &&... args)
+		{
+			size_t seg, offset;
+			locate(index, seg, offset);
+
+			std::byte * base = segment(seg);
+			new (items(base, seg) + offset) T(std::forward<Args>(args)...);
+			readyBits(base)[offset / 64].fetch_or(uint64_t(1) << (offset % 64), std::memory_order_release);
+			return index;
+		}
+
+		void destroyAll()
+		{
+			for (size_t seg = 0; seg < MaxSegments; seg++)
+			{
+				std::byte * base = m_segments[seg].load(std::memory_order_relaxed);
+				if (!base)
+					continue;
+
+				SegmentInfo const info = segmentInfo(seg);
+				for (size_t w = 0; w < info.ReadyWords; w++)
+				{
+					uint64_t bits = readyBits(base)[w].exchange(0, std::memory_order_relaxed);
+					if constexpr (!std::is_trivially_destructible_v<T>)
+						for (; bits; bits &= bits - 1)
+							items(base, seg)[w * 64 + size_t(BitscanLSB(bits))].~T();
+				}
+			}
+		}
+
+	public:
+		using value_type = T;
+
+		COPY_ASSIGN_MOVE_CTOR(ConcurrentVector, delete, delete, delete)
+
+		/// firstSegmentCapacity is rounded up to a power of two. Later segments double from there.
+		explicit ConcurrentVector(size_t firstSegmentCapacity = 64)
+			: m_firstLog2(floorLog2(NextPowerOfTwo(uint64_t(firstSegmentCapacity < 1 ? 1 : firstSegmentCapacity))))
+		{ }
+
+		~ConcurrentVector()
+		{
+			destroyAll();
+			for (size_t seg = 0; seg < MaxSegments; seg++)
+				if (std::byte * base = m_segments[seg].load(std::memory_order_relaxed))
+					::operator delete(base, std::align_val_t(ItemAlign));
+		}
+
+		/// THREAD-SAFE! Returns the index of the new element.
+		size_t push_back(T const & value) { return emplace_back(value); }
+		size_t push_back(T &&      value) { return emplace_back(std::move(value)); }
+
+		/// THREAD-SAFE! Returns the index of the new element.
+		template <typename... Args>
+		size_t emplace_back(Args &&... args)
+		{
+			return emplaceAt(m_reserved.fetch_add(1, std::memory_order_relaxed), std::forward<Args>(args)...);
+		}
+
+		/// THREAD-SAFE! Appends count copies of value at consecutive indices, and returns the first.
+		size_t grow_by(size_t count, T const & value = T())
+		{
+			size_t const first = m_reserved.fetch_add(count, std::memory_order_relaxed);
+			for (size_t i = 0; i < count; i++)
+				emplaceAt(first + i, value);
+			return first;
+		}
+
+		/// THREAD-SAFE! Makes sure the first n indices have storage, so pushes up to there never allocate.
+		void reserve(size_t n)
+		{
+			for (size_t seg = 0; n && seg < MaxSegments - m_firstLog2; seg++)
+			{
+				segment(seg);
+				if ((((size_t(1) << (seg + 1)) - 1) << m_firstLog2) >= n)
+					break;
+			}
+		}
+
+		/// THREAD-SAFE! Number of indices handed out so far, including elements still being constructed.
+		size_t size()  const { return m_reserved.load(std::memory_order_acquire); }
+		bool   empty() const { return size() == 0; }
+
+		/// THREAD-SAFE! True once element index is constructed and visible to this thread.
+		bool is_published(size_t index) const
+		{
+			size_t seg, offset;
+			locate(index, seg, offset);
+
+			std::byte * base = m_segments[seg].load(std::memory_order_acquire);
+			return base && (readyBits(base)[offset / 64].load(std::memory_order_acquire) >> (offset % 64)) & 1;
+		}
+
+		T & operator[](size_t index)
+		{
+			size_t seg, offset;
+			locate(index, seg, offset);
+			return items(m_segments[seg].load(std::memory_order_acquire), seg)[offset];
+		}
+
+		T const & operator[](size_t index) const { return const_cast<ConcurrentVector &>(*this)[index]; }
+
+		T & at(size_t index)
+		{
+			if (!is_published(index))
+				throw std::out_of_range("ConcurrentVector index is not published.");
+			return (*this)[index];
+		}
+
+		T const & at(size_t index) const { return const_cast<ConcurrentVector &>(*this).at(index); }
+
+		/// NOT THREAD-SAFE! Destroys the elements, but keeps the segments for reuse.
+		void clear()
+		{
+			destroyAll();
+			m_reserved.store(0, std::memory_order_relaxed);
+		}
+
+		/// NOT THREAD-SAFE! Calls fn(T * first, size_t count) for each contiguous run of [0, size()),
+		/// one per segment, in order. For bulk processing without per-element index math.
+		template <typename Fn>
+		void for_each_segment(Fn && fn)
+		{
+			size_t remaining = size();
+			for (size_t seg = 0; remaining; seg++)
+			{
+				size_t const n = std::min(remaining, segmentInfo(seg).Capacity);
+				fn(items(m_segments[seg].load(std::memory_order_acquire), seg), n);
+				remaining -= n;
+			}
+		}
+
+		template <bool IsConst>
+		class iterator_base
+		{
+			using owner_t = std::conditional_t<IsConst, ConcurrentVector const, ConcurrentVector>;
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type        = T;
+			using difference_type   = std::ptrdiff_t;
+			using pointer           = std::conditional_t<IsConst, T const *, T *>;
+			using reference         = std::conditional_t<IsConst, T const &, T &>;
+
+			reference       operator* () const { return (*m_owner)[m_index]; }
+			pointer         operator->() const { return &(*m_owner)[m_index]; }
+			iterator_base & operator++()       { ++m_index; return *this; }
+			iterator_base   operator++(int)    { iterator_base ret = *this; ++m_index; return ret; }
+
+			bool operator==(iterator_base const & rhs) const { return m_index == rhs.m_index; }
+			bool operator!=(iterator_base const & rhs) const { return m_index != rhs.m_index; }
+
+			friend class ConcurrentVector;
+		private:
+			owner_t * m_owner;
+			size_t    m_index;
+
+			iterator_base(owner_t * owner, size_t index) : m_owner(owner), m_index(index) { }
+		};
+
+		using iterator       = iterator_base<false>;
+		using const_iterator = iterator_base<true>;
+
+		/// NOT THREAD-SAFE! Iterates [0, size()) as of the call.
+		iterator       begin()       { return iterator(this, 0); }
+		iterator       end()         { return iterator(this, size()); }
+		const_iterator begin() const { return const_iterator(this, 0); }
+		const_iterator end()   const { return const_iterator(this, size()); }
+	};
+}
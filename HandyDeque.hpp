@@ -2,6 +2,7 @@
 /// ================================================================================
 /// Microsoft's implementation of std::deque, but with different tuning values
 /// Downloaded on: 9/18/2019 
+/// Ported to GCC/Clang, and the block size made a template parameter.
 ///     https://github.com/microsoft/STL/blob/master/stl/inc/deque
 ///
 /// LICENSE - Apache-2.0 WITH LLVM-exception
@@ -40,12 +41,14 @@
 
 #include "HandyBase.hpp"
 
-#if defined IS_WINDOWS
-
 #include <stdexcept>
 #include <stdio.h>
 #include <string.h>
 #include <algorithm>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 
 /// DEQUE PARAMETERS --- THESE MUST BE POWERS OF TWO:
@@ -59,7 +62,9 @@
 */
 /// LIBC++ VALUES:
 #define HTD_DEQUEMAPSIZE 8 // minimum map size, at least 1
-#define HTD_DEQUESIZE (sizeof(value_type) < 256 ? 4096 / sizeof(value_type) : 16) // elements per block (a power of 2)
+//#define HTD_DEQUESIZE (sizeof(value_type) < 256 ? 4096 / sizeof(value_type) : 16) // elements per block (a power of 2)
+/// The block size is now the _BlockBytes template parameter of htd::deque, see Deque_block_size.
+#define HTD_DEQUEBLOCKBYTES 4096 // default bytes per block
 
 #define HTD_ITERATOR_DEBUG_LEVEL 0
 
@@ -158,6 +163,42 @@ namespace htd {
 	using Choose_pocma = std::conditional_t<std::allocator_traits<_Alloc>::is_always_equal::value, Equal_allocators,
 		typename std::allocator_traits<_Alloc>::propagate_on_container_move_assignment::type>;
 
+	template <class _Alloc>
+	void Pocca(_Alloc& _Left, const _Alloc& _Right) noexcept // propagate on container copy assignment
+	{
+		if constexpr (std::allocator_traits<_Alloc>::propagate_on_container_copy_assignment::value)
+			_Left = _Right;
+	}
+
+	template <class _Alloc>
+	void Pocma(_Alloc& _Left, _Alloc& _Right) noexcept // propagate on container move assignment
+	{
+		if constexpr (std::allocator_traits<_Alloc>::propagate_on_container_move_assignment::value)
+			_Left = std::move(_Right);
+	}
+
+	template <class _Alloc>
+	void Pocs(_Alloc& _Left, _Alloc& _Right) noexcept // propagate on container swap
+	{
+		if constexpr (std::allocator_traits<_Alloc>::propagate_on_container_swap::value)
+		{
+			using std::swap;
+			swap(_Left, _Right);
+		}
+	}
+
+	constexpr size_t Floor_pow2(size_t _Val) noexcept
+	{
+		size_t _Ret = 1;
+		while (_Ret <= _Val / 2)
+			_Ret *= 2;
+		return _Ret;
+	}
+
+	// Elements per block: as many as fit in _BlockBytes, rounded down to a power of 2, but at least 16.
+	template <class _Ty, size_t _BlockBytes>
+	inline constexpr size_t Deque_block_size = Max_value<size_t>(16, Floor_pow2(_BlockBytes / sizeof(_Ty)));
+
 	template <class NoThrowFwdIt>
 	inline constexpr bool Use_memset_value_construct_v = std::conjunction_v<std::is_pointer<NoThrowFwdIt>,
 		std::is_scalar<Iter_value_t<NoThrowFwdIt>>, std::negation<std::is_volatile<std::remove_reference_t<Iter_ref_t<NoThrowFwdIt>>>>,
@@ -631,9 +672,11 @@ namespace htd {
 }
 
 
-#pragma pack(push, _CRT_PACKING)
-#pragma warning(push, _STL_WARNING_LEVEL)
-#pragma warning(disable : _STL_DISABLED_WARNINGS)
+#if defined IS_MSVC
+	#pragma pack(push, _CRT_PACKING)
+	#pragma warning(push, _STL_WARNING_LEVEL)
+	#pragma warning(disable : _STL_DISABLED_WARNINGS)
+#endif
 HTD_STL_DISABLE_CLANG_WARNINGS
 #pragma push_macro("new")
 #undef new
@@ -646,6 +689,7 @@ class DequeUnchecked_const_iterator
 {
 private:
 	using _Size_type = typename _Mydeque::size_type;
+	static constexpr _Size_type _Block_size = _Mydeque::_Block_size;
 
 public:
 	using iterator_category = std::random_access_iterator_tag;
@@ -663,7 +707,7 @@ public:
 	[[nodiscard]] reference operator*() const
 	{
 		_Size_type _Block = _Mycont->_Getblock(_Myoff);
-		_Size_type _Off   = _Myoff % HTD_DEQUESIZE;
+		_Size_type _Off   = _Myoff % _Block_size;
 		return _Mycont->_Map[_Block][_Off];
 	}
 
@@ -748,6 +792,7 @@ class Deque_const_iterator : public Iterator_base12
 {
 private:
 	using _Size_type = typename _Mydeque::size_type;
+	static constexpr _Size_type _Block_size = _Mydeque::_Block_size;
 
 public:
 	using iterator_category = std::random_access_iterator_tag;
@@ -758,7 +803,7 @@ public:
 	using reference       = const value_type&;
 
 	using _Mydeque_t = _Mydeque; // helper for expression evaluator
-	enum { _EEN_DS = HTD_DEQUESIZE }; // helper for expression evaluator
+	enum { _EEN_DS = _Block_size }; // helper for expression evaluator
 	Deque_const_iterator() noexcept : _Myoff(0) {
 		_Setcont(nullptr);
 	}
@@ -778,7 +823,7 @@ public:
 		#endif // HTD_ITERATOR_DEBUG_LEVEL != 0
 
 		_Size_type _Block = _Mycont->_Getblock(_Myoff);
-		_Size_type _Off   = _Myoff % HTD_DEQUESIZE;
+		_Size_type _Off   = _Myoff % _Block_size;
 		return _Mycont->_Map[_Block][_Off];
 	}
 
@@ -954,9 +999,11 @@ template <class _Mydeque>
 
 // deque TYPE WRAPPERS
 template <class _Value_type, class _Size_type, class _Difference_type, class _Pointer, class _Const_pointer,
-	class _Reference, class _Const_reference, class _Mapptr_type>
+	class _Reference, class _Const_reference, class _Mapptr_type, size_t _Block>
 struct Deque_iter_types
 {
+	static constexpr size_t _Block_size = _Block;
+
 	using value_type      = _Value_type;
 	using size_type       = _Size_type;
 	using difference_type = _Difference_type;
@@ -965,9 +1012,11 @@ struct Deque_iter_types
 	using _Mapptr         = _Mapptr_type;
 };
 
-template <class _Ty>
+template <class _Ty, size_t _Block>
 struct Deque_simple_types
 {
+	static constexpr size_t _Block_size = _Block;
+
 	using value_type      = _Ty;
 	using size_type       = size_t;
 	using difference_type = ptrdiff_t;
@@ -991,10 +1040,12 @@ public:
 	using const_reference = const value_type&;
 	using _Mapptr         = typename _Val_types::_Mapptr;
 
+	static constexpr size_type _Block_size = _Val_types::_Block_size; // elements per block, a power of 2
+
 	Deque_val() noexcept : _Map(), _Mapsize(0), _Myoff(0), _Mysize(0) {}
 
-	// NB: _Mapsize and HTD_DEQUESIZE are guaranteed to be powers of 2
-	size_type _Getblock(size_type _Off) const noexcept { return (_Off / HTD_DEQUESIZE) & (_Mapsize - 1); }
+	// NB: _Mapsize and _Block_size are guaranteed to be powers of 2
+	size_type _Getblock(size_type _Off) const noexcept { return (_Off / _Block_size) & (_Mapsize - 1); }
 
 	_Mapptr _Map; // pointer to array of pointers to blocks
 	size_type _Mapsize; // size of map array, zero or 2^N
@@ -1003,7 +1054,7 @@ public:
 };
 
 // CLASS TEMPLATE deque
-template <class _Ty, class _Alloc = std::allocator<_Ty>>
+template <class _Ty, class _Alloc = std::allocator<_Ty>, size_t _BlockBytes = HTD_DEQUEBLOCKBYTES>
 class deque {
 private:
 	friend Tidy_guard<deque>;
@@ -1018,9 +1069,11 @@ private:
 	using _Alproxy_ty     = Rebind_alloc_t<_Alty, Container_proxy>;
 	using _Alproxy_traits = std::allocator_traits<_Alproxy_ty>;
 
-	using _Scary_val = Deque_val<std::conditional_t<Is_simple_alloc_v<_Alty>, Deque_simple_types<_Ty>,
+	using _Scary_val = Deque_val<std::conditional_t<Is_simple_alloc_v<_Alty>, Deque_simple_types<_Ty, Deque_block_size<_Ty, _BlockBytes>>,
 		Deque_iter_types<_Ty, typename _Alty_traits::size_type, typename _Alty_traits::difference_type,
-		typename _Alty_traits::pointer, typename _Alty_traits::const_pointer, _Ty&, const _Ty&, _Mapptr>>>;
+		typename _Alty_traits::pointer, typename _Alty_traits::const_pointer, _Ty&, const _Ty&, _Mapptr, Deque_block_size<_Ty, _BlockBytes>>>>;
+
+	static constexpr size_t _Block_size = _Scary_val::_Block_size;
 
 public:
 	using allocator_type  = _Alloc;
@@ -1039,7 +1092,7 @@ public:
 
 	using reverse_iterator       = std::reverse_iterator<iterator>;
 	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
-	enum { _EEN_DS = HTD_DEQUESIZE }; // helper for expression evaluator
+	enum { _EEN_DS = _Block_size }; // helper for expression evaluator
 
 	deque() : _Mypair(Zero_then_variadic_args_t()) { _Get_data()._Alloc_proxy(static_cast<_Alproxy_ty>(_Getal())); }
 
@@ -1155,7 +1208,7 @@ private:
 	void _Move_assign(deque& _Right, Equal_allocators) noexcept
 	{
 		_Tidy();
-		_Pocma(_Getal(), _Right._Getal());
+		Pocma(_Getal(), _Right._Getal());
 		_Take_contents(_Right);
 	}
 
@@ -1169,7 +1222,7 @@ private:
 			_Alproxy_ty _Right_alproxy(_Right_al);
 			Container_proxy_ptr12<_Alproxy_ty> _Proxy(_Right_alproxy, Leave_proxy_unbound{});
 			_Tidy();
-			_Pocma(_Al, _Right_al);
+			Pocma(_Al, _Right_al);
 			_Proxy._Bind(_Alproxy, std::addressof(_Get_data()));
 			_Take_contents(_Right);
 		}
@@ -1219,15 +1272,15 @@ public:
 		_Orphan_all();
 		
 		//PUSH_FRONT_BEGIN:
-			if (_Myoff() % HTD_DEQUESIZE == 0 && _Mapsize() <= (_Mysize() + HTD_DEQUESIZE) / HTD_DEQUESIZE)
+			if (_Myoff() % _Block_size == 0 && _Mapsize() <= (_Mysize() + _Block_size) / _Block_size)
 				_Growmap(1);
-			_Myoff() &= _Mapsize() * HTD_DEQUESIZE - 1;
-			size_type _Newoff = _Myoff() != 0 ? _Myoff() : _Mapsize() * HTD_DEQUESIZE;
+			_Myoff() &= _Mapsize() * _Block_size - 1;
+			size_type _Newoff = _Myoff() != 0 ? _Myoff() : _Mapsize() * _Block_size;
 			size_type _Block = _Getblock(--_Newoff);
 			if (_Map()[_Block] == nullptr) 
-				_Map()[_Block] = _Getal().allocate(HTD_DEQUESIZE);
+				_Map()[_Block] = _Getal().allocate(_Block_size);
 
-		_Alty_traits::construct(_Getal(), Unfancy(_Map()[_Block] + _Newoff % HTD_DEQUESIZE), std::move(_Val));
+		_Alty_traits::construct(_Getal(), Unfancy(_Map()[_Block] + _Newoff % _Block_size), std::move(_Val));
 		
 		//PUSH_FRONT_END:
 			_Myoff() = _Newoff;
@@ -1251,15 +1304,15 @@ public:
 		_Orphan_all();
 
 		//PUSH_FRONT_BEGIN:
-			if (_Myoff() % HTD_DEQUESIZE == 0 && _Mapsize() <= (_Mysize() + HTD_DEQUESIZE) / HTD_DEQUESIZE)
+			if (_Myoff() % _Block_size == 0 && _Mapsize() <= (_Mysize() + _Block_size) / _Block_size)
 				_Growmap(1);
-			_Myoff() &= _Mapsize() * HTD_DEQUESIZE - 1;
-			size_type _Newoff = _Myoff() != 0 ? _Myoff() : _Mapsize() * HTD_DEQUESIZE;
+			_Myoff() &= _Mapsize() * _Block_size - 1;
+			size_type _Newoff = _Myoff() != 0 ? _Myoff() : _Mapsize() * _Block_size;
 			size_type _Block = _Getblock(--_Newoff);
 			if (_Map()[_Block] == nullptr) 
-				_Map()[_Block] = _Getal().allocate(HTD_DEQUESIZE);
+				_Map()[_Block] = _Getal().allocate(_Block_size);
 
-		_Alty_traits::construct(_Getal(), Unfancy(_Map()[_Block] + _Newoff % HTD_DEQUESIZE), std::forward<_Valty>(_Val)...);
+		_Alty_traits::construct(_Getal(), Unfancy(_Map()[_Block] + _Newoff % _Block_size), std::forward<_Valty>(_Val)...);
 		
 		//PUSH_FRONT_END:
 			_Myoff() = _Newoff;
@@ -1276,17 +1329,17 @@ public:
 		_Orphan_all();
 
 		//PUSH_BACK_BEGIN:
-			if ((_Myoff() + _Mysize()) % HTD_DEQUESIZE == 0 && _Mapsize() <= (_Mysize() + HTD_DEQUESIZE) / HTD_DEQUESIZE)
+			if ((_Myoff() + _Mysize()) % _Block_size == 0 && _Mapsize() <= (_Mysize() + _Block_size) / _Block_size)
 				_Growmap(1);
-			_Myoff() &= _Mapsize() * HTD_DEQUESIZE - 1;
+			_Myoff() &= _Mapsize() * _Block_size - 1;
 			size_type _Newoff = _Myoff() + _Mysize();
 			size_type _Block = _Getblock(_Newoff);
 			if (_Map()[_Block] == nullptr)
-				_Map()[_Block] = _Getal().allocate(HTD_DEQUESIZE);
+				_Map()[_Block] = _Getal().allocate(_Block_size);
 
 
 		_Alty_traits::construct(
-			_Getal(), Unfancy(_Map()[_Block] + _Newoff % HTD_DEQUESIZE), std::forward<_Valty>(_Val)...);
+			_Getal(), Unfancy(_Map()[_Block] + _Newoff % _Block_size), std::forward<_Valty>(_Val)...);
 
 		//PUSH_BACK_END:
 			++_Mysize();
@@ -1352,7 +1405,7 @@ public:
 
 	void _Copy_assign(const deque& _Right, std::false_type)
 	{
-		_Pocca(_Getal(), _Right._Getal());
+		Pocca(_Getal(), _Right._Getal());
 		assign(_Right._Unchecked_begin(), _Right._Unchecked_end());
 	}
 
@@ -1398,11 +1451,11 @@ public:
 
 	void shrink_to_fit() 
 	{
-		size_type _Oldcapacity = HTD_DEQUESIZE * _Mapsize();
+		size_type _Oldcapacity = _Block_size * _Mapsize();
 		size_type _Newcapacity = _Oldcapacity / 2;
 
-		if (_Newcapacity < HTD_DEQUESIZE * HTD_DEQUEMAPSIZE)
-			_Newcapacity = HTD_DEQUESIZE * HTD_DEQUEMAPSIZE;
+		if (_Newcapacity < _Block_size * HTD_DEQUEMAPSIZE)
+			_Newcapacity = _Block_size * HTD_DEQUEMAPSIZE;
 
 		if ((empty() && 0 < _Mapsize())
 			|| (!empty() && size() <= _Newcapacity && _Newcapacity < _Oldcapacity)) { // worth shrinking, do it
@@ -1513,15 +1566,15 @@ public:
 		_Orphan_all();
 
 		//PUSH_FRONT_BEGIN:
-			if (_Myoff() % HTD_DEQUESIZE == 0 && _Mapsize() <= (_Mysize() + HTD_DEQUESIZE) / HTD_DEQUESIZE)
+			if (_Myoff() % _Block_size == 0 && _Mapsize() <= (_Mysize() + _Block_size) / _Block_size)
 				_Growmap(1);
-			_Myoff() &= _Mapsize() * HTD_DEQUESIZE - 1;
-			size_type _Newoff = _Myoff() != 0 ? _Myoff() : _Mapsize() * HTD_DEQUESIZE;
+			_Myoff() &= _Mapsize() * _Block_size - 1;
+			size_type _Newoff = _Myoff() != 0 ? _Myoff() : _Mapsize() * _Block_size;
 			size_type _Block = _Getblock(--_Newoff);
 			if (_Map()[_Block] == nullptr) 
-				_Map()[_Block] = _Getal().allocate(HTD_DEQUESIZE);
+				_Map()[_Block] = _Getal().allocate(_Block_size);
 
-		_Alty_traits::construct(_Getal(), Unfancy(_Map()[_Block] + _Newoff % HTD_DEQUESIZE), _Val);
+		_Alty_traits::construct(_Getal(), Unfancy(_Map()[_Block] + _Newoff % _Block_size), _Val);
 		
 		//PUSH_FRONT_END:
 			_Myoff() = _Newoff;
@@ -1536,7 +1589,7 @@ public:
 		} else { // something to erase, do it
 			_Orphan_off(_Myoff());
 			size_type _Block = _Getblock(_Myoff());
-			_Alty_traits::destroy(_Getal(), Unfancy(_Map()[_Block] + _Myoff() % HTD_DEQUESIZE));
+			_Alty_traits::destroy(_Getal(), Unfancy(_Map()[_Block] + _Myoff() % _Block_size));
 			if (--_Mysize() == 0) {
 				_Myoff() = 0;
 			} else {
@@ -1546,7 +1599,7 @@ public:
 
 		#else // HTD_ITERATOR_DEBUG_LEVEL == 2
 		size_type _Block = _Getblock(_Myoff());
-		_Alty_traits::destroy(_Getal(), Unfancy(_Map()[_Block] + _Myoff() % HTD_DEQUESIZE));
+		_Alty_traits::destroy(_Getal(), Unfancy(_Map()[_Block] + _Myoff() % _Block_size));
 		if (--_Mysize() == 0) {
 			_Myoff() = 0;
 		} else {
@@ -1560,15 +1613,15 @@ private:
 	void _Emplace_back_internal(_Tys&&... _Vals)
 	{
 		//PUSH_BACK_BEGIN:
-			if ((_Myoff() + _Mysize()) % HTD_DEQUESIZE == 0 && _Mapsize() <= (_Mysize() + HTD_DEQUESIZE) / HTD_DEQUESIZE)
+			if ((_Myoff() + _Mysize()) % _Block_size == 0 && _Mapsize() <= (_Mysize() + _Block_size) / _Block_size)
 				_Growmap(1);
-			_Myoff() &= _Mapsize() * HTD_DEQUESIZE - 1;
+			_Myoff() &= _Mapsize() * _Block_size - 1;
 			size_type _Newoff = _Myoff() + _Mysize();
 			size_type _Block = _Getblock(_Newoff);
 			if (_Map()[_Block] == nullptr)
-				_Map()[_Block] = _Getal().allocate(HTD_DEQUESIZE);
+				_Map()[_Block] = _Getal().allocate(_Block_size);
 
-		_Alty_traits::construct(_Getal(), Unfancy(_Map()[_Block] + _Newoff % HTD_DEQUESIZE), std::forward<_Tys>(_Vals)...);
+		_Alty_traits::construct(_Getal(), Unfancy(_Map()[_Block] + _Newoff % _Block_size), std::forward<_Tys>(_Vals)...);
 		//PUSH_BACK_END:
 			++_Mysize();
 	}
@@ -1589,7 +1642,7 @@ public:
 			size_type _Newoff = _Myoff() + _Mysize() - 1;
 			_Orphan_off(_Newoff);
 			size_type _Block = _Getblock(_Newoff);
-			_Alty_traits::destroy(_Getal(), Unfancy(_Map()[_Block] + _Newoff % HTD_DEQUESIZE));
+			_Alty_traits::destroy(_Getal(), Unfancy(_Map()[_Block] + _Newoff % _Block_size));
 			if (--_Mysize() == 0) {
 				_Myoff() = 0;
 			}
@@ -1598,7 +1651,7 @@ public:
 		#else // HTD_ITERATOR_DEBUG_LEVEL == 2
 		size_type _Newoff = _Myoff() + _Mysize() - 1;
 		size_type _Block  = _Getblock(_Newoff);
-		_Alty_traits::destroy(_Getal(), Unfancy(_Map()[_Block] + _Newoff % HTD_DEQUESIZE));
+		_Alty_traits::destroy(_Getal(), Unfancy(_Map()[_Block] + _Newoff % _Block_size));
 		if (--_Mysize() == 0) {
 			_Myoff() = 0;
 		}
@@ -1795,7 +1848,7 @@ public:
 	{
 		if (this != std::addressof(_Right)) 
 		{
-			_Pocs(_Getal(), _Right._Getal());
+			Pocs(_Getal(), _Right._Getal());
 			auto& _My_data    = _Get_data();
 			auto& _Right_data = _Right._Get_data();
 			_My_data._Swap_proxy_and_iterators(_Right_data);
@@ -1897,7 +1950,7 @@ private:
 		while (_Newsize - _Mapsize() < _Count || _Newsize < HTD_DEQUEMAPSIZE)
 		{
 			// scale _Newsize to 2^N >= _Mapsize() + _Count
-			if (max_size() / HTD_DEQUESIZE - _Newsize < _Newsize)
+			if (max_size() / _Block_size - _Newsize < _Newsize)
 			{
 				throw std::length_error("deque<T> too long"); // result too long
 			}
@@ -1907,7 +1960,7 @@ private:
 
 		_Count = _Newsize - _Mapsize();
 
-		size_type _Myboff = _Myoff() / HTD_DEQUESIZE;
+		size_type _Myboff = _Myoff() / _Block_size;
 		_Mapptr _Newmap   = _Almap.allocate(_Mapsize() + _Count);
 		_Mapptr _Myptr    = _Newmap + _Myboff;
 
@@ -1945,7 +1998,7 @@ private:
 
 		for (size_type _Block = _Mapsize(); 0 < _Block;) { // free storage for a block and destroy pointer
 			if (_Map()[--_Block]) { // free block and destroy its pointer
-				_Getal().deallocate(_Map()[_Block], HTD_DEQUESIZE);
+				_Getal().deallocate(_Map()[_Block], _Block_size);
 				Destroy_in_place(_Map()[_Block]);
 			}
 		}
@@ -2006,44 +2059,44 @@ template <class _Iter, class _Alloc = std::allocator<Iter_value_t<_Iter>>,
 	deque(_Iter, _Iter, _Alloc = _Alloc())->deque<Iter_value_t<_Iter>, _Alloc>;
 #endif // HTD_HAS_CXX17
 
-template <class _Ty, class _Alloc>
-void swap(deque<_Ty, _Alloc>& _Left, deque<_Ty, _Alloc>& _Right) noexcept /* strengthened */ 
+template <class _Ty, class _Alloc, size_t _BlockBytes>
+void swap(deque<_Ty, _Alloc, _BlockBytes>& _Left, deque<_Ty, _Alloc, _BlockBytes>& _Right) noexcept /* strengthened */ 
 {
 	_Left.swap(_Right); 
 }
 
-template <class _Ty, class _Alloc>
-[[nodiscard]] bool operator==(const deque<_Ty, _Alloc>& _Left, const deque<_Ty, _Alloc>& _Right) 
+template <class _Ty, class _Alloc, size_t _BlockBytes>
+[[nodiscard]] bool operator==(const deque<_Ty, _Alloc, _BlockBytes>& _Left, const deque<_Ty, _Alloc, _BlockBytes>& _Right) 
 {
 	return _Left.size() == _Right.size() && std::equal(_Left._Unchecked_begin(), _Left._Unchecked_end(), _Right._Unchecked_begin());
 }
 
-template <class _Ty, class _Alloc>
-[[nodiscard]] bool operator!=(const deque<_Ty, _Alloc>& _Left, const deque<_Ty, _Alloc>& _Right)
+template <class _Ty, class _Alloc, size_t _BlockBytes>
+[[nodiscard]] bool operator!=(const deque<_Ty, _Alloc, _BlockBytes>& _Left, const deque<_Ty, _Alloc, _BlockBytes>& _Right)
 {
 	return !(_Left == _Right);
 }
 
-template <class _Ty, class _Alloc>
-[[nodiscard]] bool operator<(const deque<_Ty, _Alloc>& _Left, const deque<_Ty, _Alloc>& _Right) 
+template <class _Ty, class _Alloc, size_t _BlockBytes>
+[[nodiscard]] bool operator<(const deque<_Ty, _Alloc, _BlockBytes>& _Left, const deque<_Ty, _Alloc, _BlockBytes>& _Right) 
 {
 	return std::lexicographical_compare(_Left._Unchecked_begin(), _Left._Unchecked_end(), _Right._Unchecked_begin(), _Right._Unchecked_end());
 }
 
-template <class _Ty, class _Alloc>
-[[nodiscard]] bool operator<=(const deque<_Ty, _Alloc>& _Left, const deque<_Ty, _Alloc>& _Right)
+template <class _Ty, class _Alloc, size_t _BlockBytes>
+[[nodiscard]] bool operator<=(const deque<_Ty, _Alloc, _BlockBytes>& _Left, const deque<_Ty, _Alloc, _BlockBytes>& _Right)
 {
 	return !(_Right < _Left);
 }
 
-template <class _Ty, class _Alloc>
-[[nodiscard]] bool operator>(const deque<_Ty, _Alloc>& _Left, const deque<_Ty, _Alloc>& _Right) 
+template <class _Ty, class _Alloc, size_t _BlockBytes>
+[[nodiscard]] bool operator>(const deque<_Ty, _Alloc, _BlockBytes>& _Left, const deque<_Ty, _Alloc, _BlockBytes>& _Right) 
 {
 	return _Right < _Left;
 }
 
-template <class _Ty, class _Alloc>
-[[nodiscard]] bool operator>=(const deque<_Ty, _Alloc>& _Left, const deque<_Ty, _Alloc>& _Right)
+template <class _Ty, class _Alloc, size_t _BlockBytes>
+[[nodiscard]] bool operator>=(const deque<_Ty, _Alloc, _BlockBytes>& _Left, const deque<_Ty, _Alloc, _BlockBytes>& _Right)
 {
 	return !(_Left < _Right);
 }
@@ -2052,17 +2105,9 @@ template <class _Ty, class _Alloc>
 
 #pragma pop_macro("new")
 HTD_STL_RESTORE_CLANG_WARNINGS
-#pragma warning(pop)
-#pragma pack(pop)
-
-#else
-	#include <deque>
-	namespace htd
-	{
-		template <class _Ty, class _Alloc = std::allocator<_Ty>> 
-		using deque = std::deque<_Ty, _Alloc>;
-	}
-
+#if defined IS_MSVC
+	#pragma warning(pop)
+	#pragma pack(pop)
 #endif
 
 
@@ -32,7 +32,9 @@
 #include <fcntl.h>
 #include <cstdio>
 
+#include "HandyCache.hpp"
 #include "HandyDeque.hpp"
+#include "HandyHash.hpp"
 #include "HandyMemory.hpp"
 #include "HandyThreadUtils.hpp"
 #include "HandyUtils.hpp"
@@ -469,8 +471,16 @@ namespace HANDY_NS {
 
 	// VERY fast and compressed file that can be read or appended. Always append as much data at a time as possible, since
 	// any data below the block size will temporarily be stored in a "-tl" file on Flush or Close.
+	//
+	// On disk, each block is [CompactSize][PayloadSize] (uint64 each) then the compressed data. If the top bit of
+	// PayloadSize is set (ChecksumFlag), a uint64 holding the CRC32C of the rest of the block follows the sizes, and is
+	// checked whenever the block is loaded. Blocks written before checksums existed never have the bit set.
 	class CompressedAppendFile
 	{
+	public:
+		static constexpr uint64_t ChecksumFlag = 1_u64 << 63;
+
+	private:
 		class CABlock
 		{
 			COPY_ASSIGN_MOVE_CTOR(CABlock, delete, delete, delete);
@@ -485,19 +495,30 @@ namespace HANDY_NS {
 			uint64_t PayloadSize; // Size of the data payload for this block. SHOULD BE detail::BLOCK_SIZE
 			uint64_t CompactSize; // Size of the data payload as compressed on disk.
 
+			bool     HasChecksum = false;
+			uint32_t Checksum    = 0; // CRC32C of the sizes (as on disk, flag included) and the compressed data.
+
 
 			std::vector<std::byte> * Data = nullptr; // If currently loaded.
 
 			void ReadInfo()
 			{
-				std::array<uint64_t, 2> sizes;
+				std::array<uint64_t, 3> header;
 				m_file.Seek(AccessPosition::Read, FileOffset);
-				m_file.Read(&sizes[0], sizeof(uint64_t) * 2);
-				CompactSize = sizes[0];
-				PayloadSize = sizes[1]; /// This should be detail::BLOCK_SIZE.
+				m_file.Read(&header[0], sizeof(uint64_t) * 2);
+				CompactSize = header[0];
+				PayloadSize = header[1] & ~ChecksumFlag; /// This should be detail::BLOCK_SIZE.
+				HasChecksum = (header[1] & ChecksumFlag) != 0;
+
+				if (HasChecksum)
+				{
+					m_file.Read(&header[2], sizeof(uint64_t));
+					Checksum = uint32_t(header[2]);
+				}
 			}
 
-			uint64_t NextBlockFileOffset() const { return FileOffset + 16 + CompactSize; }
+			uint64_t HeaderSize()          const { return HasChecksum ? 24 : 16; }
+			uint64_t NextBlockFileOffset() const { return FileOffset + HeaderSize() + CompactSize; }
 			
 			bool IsLoaded() const { return Data != nullptr; }
 
@@ -506,9 +527,26 @@ namespace HANDY_NS {
 				if (Data)
 					return;
 
-				m_file.Seek(AccessPosition::Read, FileOffset);
-				std::vector<std::byte> compressedData;
-				m_file.ReadTo(compressedData, CompactSize + 16);
+				/// Read the data in after a plain 16 byte sizes section, which is what Decode expects.
+				std::vector<std::byte> compressedData(CompactSize + 16);
+				m_file.Seek(AccessPosition::Read, FileOffset + HeaderSize());
+				if (!m_file.Read(&compressedData[16], CompactSize))
+					throw std::runtime_error("CompressedAppendFile - Block is truncated.");
+
+				std::array<uint64_t, 2> sizes = { CompactSize, PayloadSize | (HasChecksum ? ChecksumFlag : 0) };
+
+				if (HasChecksum)
+				{
+					uint32_t crc = Hash::CRC32C::Hash(&sizes[0], 16);
+					crc = Hash::CRC32C::Hash(&compressedData[16], CompactSize, crc);
+
+					if (crc != Checksum)
+						throw std::runtime_error("CompressedAppendFile - Block checksum mismatch, the file is corrupt.");
+				}
+
+				sizes[1] = PayloadSize;
+				memcpy(&compressedData[0], &sizes[0], 16);
+
 				Data = new std::vector<std::byte>();
 				Encoding<EncodingScheme::Shrinker>::Decode(*Data, compressedData);
 			}
@@ -526,19 +564,21 @@ namespace HANDY_NS {
 			}
 
 			/// Used when appending new blocks, avoids an unnecessary file read
-			CABlock(File & file, uint64_t fileOffset, uint64_t payloadSize, uint64_t compactSize)
+			CABlock(File & file, uint64_t fileOffset, uint64_t payloadSize, uint64_t compactSize, bool hasChecksum, uint32_t checksum)
 				: m_file(file)
 				, FileOffset(fileOffset)
 				, PayloadSize(payloadSize)
 				, CompactSize(compactSize)
+				, HasChecksum(hasChecksum)
+				, Checksum(checksum)
 			{ }
 
 			~CABlock() { EnsureUnloaded(); }
 		};
 
 	public:
-		static constexpr uint64_t BlockSize       = detail::BLOCK_SIZE;
-		//static constexpr uint64_t MaxBlocksCached = 64;
+		static constexpr uint64_t BlockSize              = detail::BLOCK_SIZE;
+		static constexpr uint64_t DefaultMaxBlocksCached = 8; /// Decoded blocks kept in memory, BlockSize bytes each.
 		static char const *       PartialFileExt() { return "-tl"; }
 
 		COPY_ASSIGN_MOVE_CTOR(CompressedAppendFile, delete, delete, delete);
@@ -547,13 +587,14 @@ namespace HANDY_NS {
 		std::filesystem::path m_path;
 				
 		File m_file;
-		bool m_isOpen    = false;
-		bool m_isFlushed = true;
+		bool m_isOpen          = false;
+		bool m_isFlushed       = true;
+		bool m_writeChecksums  = true;
 
-		//htd::deque <CABlock*> m_cachedBlocks;
 		std::vector<CABlock*> m_blocks;
 
-		CABlock * m_lastCachedBlock = nullptr;
+		/// Block index -> block, for the blocks that are currently decoded. Evicting unloads.
+		LRUCache<uint64_t, CABlock *> m_cachedBlocks{ DefaultMaxBlocksCached };
 
 		uint64_t m_fileSize  = 0; /// Does NOT include m_partial, and is compressed!
 
@@ -570,7 +611,8 @@ namespace HANDY_NS {
 
 			struct BlockInfo
 			{
-				std::byte *          Src = nullptr;
+				std::byte *          Src      = nullptr;
+				uint64_t             Checksum = 0;
 				std::vector<uint8_t> CompressedData;
 
 				BlockInfo() : CompressedData(BlockSize) { }
@@ -589,10 +631,21 @@ namespace HANDY_NS {
 			
 			Handy::WorkPool<BlockInfo *> wp;
 			wp.SetThreadNames("Handy::CompressedAppendFile");
-			wp.SetTask([this](BlockInfo * tb)
+			bool const withChecksums = m_writeChecksums;
+			wp.SetTask([withChecksums](BlockInfo * tb)
 			{
 				/// This automatically adds size info at the front of the block!
 				Encoding<EncodingScheme::Shrinker>::Encode(tb->CompressedData, std::span<std::byte>(tb->Src, BlockSize));
+
+				if (withChecksums)
+				{
+					uint64_t payloadSize;
+					memcpy(&payloadSize, &tb->CompressedData[8], 8);
+					payloadSize |= ChecksumFlag;
+					memcpy(&tb->CompressedData[8], &payloadSize, 8);
+
+					tb->Checksum = Hash::CRC32C::Hash(tb->CompressedData.data(), tb->CompressedData.size());
+				}
 			});
 			
 			for (auto & tb : tbs)
@@ -602,12 +655,22 @@ namespace HANDY_NS {
 
 			for (auto & tb : tbs)
 			{
-				m_file.Write(&tb.CompressedData[0], tb.CompressedData.size());
 				std::array<uint64_t, 2> sizes;
 				memcpy(&sizes[0], &tb.CompressedData[0], 8 * 2);
-				CABlock * nuBlock = new CABlock(m_file, m_fileSize, sizes[1], sizes[0]); /// Prespecify these values so we don't have to reread them from disk.
+
+				if (withChecksums)
+				{
+					m_file.Write(&tb.CompressedData[0], 16);
+					m_file.Write(&tb.Checksum, 8);
+					m_file.Write(&tb.CompressedData[16], tb.CompressedData.size() - 16);
+				}
+				else
+					m_file.Write(&tb.CompressedData[0], tb.CompressedData.size());
+
+				/// Prespecify these values so we don't have to reread them from disk.
+				CABlock * nuBlock = new CABlock(m_file, m_fileSize, sizes[1] & ~ChecksumFlag, sizes[0], withChecksums, uint32_t(tb.Checksum));
 				m_blocks.push_back(nuBlock);
-				m_fileSize += tb.CompressedData.size();
+				m_fileSize += nuBlock->HeaderSize() + nuBlock->CompactSize;
 			}
 
 			m_file.Flush();
@@ -655,13 +718,19 @@ namespace HANDY_NS {
 			m_isFlushed = true;
 			//m_pathP = std::filesystem::path();
 
+			m_cachedBlocks.clear();
+
 			for (auto iP : m_blocks)
 				delete iP;
 
 			m_blocks.clear();
 		}
 
-		 CompressedAppendFile() = default;
+		CompressedAppendFile()
+		{
+			m_cachedBlocks.set_eviction_callback([](uint64_t const &, CABlock * & block) { block->EnsureUnloaded(); });
+		}
+
 		~CompressedAppendFile() { Close(); }
 
 		bool Open(std::filesystem::path path, bool resetFile = false)
@@ -740,6 +809,13 @@ namespace HANDY_NS {
 			//std::cout << "     Final m_partialData size: " << m_partialData.size() << std::endl;
 		}
 
+		/// Whether new blocks carry a CRC32C (on by default). Files with checksummed blocks can't be read by versions of
+		/// this class from before checksums existed, so turn this off to keep writing files those can still read.
+		void SetWriteChecksums(bool writeChecksums) { m_writeChecksums = writeChecksums; }
+
+		/// How many decoded blocks to keep for reads. Each costs BlockSize bytes.
+		void SetMaxBlocksCached(uint64_t maxBlocks) { m_cachedBlocks.set_capacity(size_t(FastMax(maxBlocks, 1_u64))); }
+
 		uint64_t SizeBytes()           { return m_blocks.size() * BlockSize + (uint64_t)m_partialData.size(); }
 		uint64_t SizeBytesCompressed()
 		{
@@ -776,12 +852,10 @@ namespace HANDY_NS {
 					numBlockBytesToCopy = FastMin(numBytes, BlockSize - bOffset);
 
 					CABlock * block = m_blocks.at(bIndex);
-					if (block != m_lastCachedBlock)
+					if (!m_cachedBlocks.get(bIndex))
 					{
-						if (m_lastCachedBlock)
-							m_lastCachedBlock->EnsureUnloaded();
 						block->EnsureLoaded();
-						m_lastCachedBlock = block;
+						m_cachedBlocks.insert(bIndex, block);
 					}
 
 					if (numBlockBytesToCopy > 0)
@@ -0,0 +1,488 @@
+
+/// ========================================================================
+/// UNLICENSE
+///
+/// This is free and unencumbered software released into the public domain.
+/// Anyone is free to copy, modify, publish, use, compile, sell, or
+/// distribute this software, either in source code form or as a compiled
+/// binary, for any purpose, commercial or non-commercial, and by any
+/// means.
+///
+/// In jurisdictions that recognize copyright laws, the author or authors
+/// of this software dedicate any and all copyright interest in the
+/// software to the public domain. We make this dedication for the benefit
+/// of the public at large and to the detriment of our heirs and
+/// successors. We intend this dedication to be an overt act of
+/// relinquishment in perpetuity of all present and future rights to this
+/// software under copyright law.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+/// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+/// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+/// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+/// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/// OTHER DEALINGS IN THE SOFTWARE.
+///
+/// For more information, please refer to <http://unlicense.org/>
+/// ========================================================================
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "HandyBase.hpp"
+#include "HandyHash.hpp"
+#include "HandySerDe.hpp"
+#include "HandySystemInfo.hpp"
+#include "HandyUtils.hpp"
+
+#if defined IS_X64
+	#include <immintrin.h>
+#endif
+
+namespace HANDY_NS {
+
+	namespace detail {
+
+		/// Keys are anything SerDe can make a span of (arithmetic types, strings, string_views,
+		/// vectors, spans...), hashed with XXHash64.
+		template <typename TKey>
+		uint64_t FilterKeyHash(TKey const & key)
+		{
+			Serializer<TKey> src;
+			auto srcSpan = src.get_span(key);
+			return Hash::XXHash64::Hash(srcSpan.data(), srcSpan.size());
+		}
+
+		FORCEINLINE uint64_t FilterBytesHash(void const * data, size_t size) { return Hash::XXHash64::Hash(data, size); }
+
+		/// Maps 32 random bits onto [0, n) without a divide.
+		FORCEINLINE uint64_t FilterFastRange(uint32_t x, uint64_t n) { return (uint64_t(x) * n) >> 32; }
+	}
+
+	///-----------------------------------------------
+	/// Bloom Filter
+	/// Blocked Bloom filter: each key sets (and probes) 8 bits, all inside one 64-byte block, so a
+	/// lookup touches a single cache line. The block comes from the high half of the key's 64-bit hash,
+	/// and the 8 bits from the low half: one bit in each of the block's 8 words, at (low * Salt[i]) >> 26.
+	///
+	/// contains_many() does batches of pre-hashed keys with AVX2 where available: all 8 bit positions in
+	/// one multiply and shift, and the test in two vector compares.
+	///
+	/// No false negatives. False positives at the rate asked for in the constructor (for rates from
+	/// MinFalsePositiveRate to MaxFalsePositiveRate), once it holds the expected number of keys. Can't remove keys (see CuckooFilter).
+	class BloomFilter
+	{
+	public:
+		static constexpr size_t WordsPerBlock = 8;
+		static constexpr size_t BitsPerBlock  = WordsPerBlock * 64;
+
+		/// With 8 bits per key fixed, space per key climbs steeply below this (35 bits per key at 1e-5, 52
+		/// at 1e-6), so a different filter would serve better. Rates outside the range are clamped.
+		static constexpr double MinFalsePositiveRate = 1e-5;
+		static constexpr double MaxFalsePositiveRate = 0.5;
+
+	private:
+		struct alignas(64) Block { uint64_t Words[WordsPerBlock]; };
+
+		static constexpr uint32_t Salt[WordsPerBlock] = { 0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U };
+
+		std::vector<Block> m_blocks;
+		uint64_t           m_count = 0;
+
+		FORCEINLINE size_t        blockIndex(uint64_t hash) const { return size_t(detail::FilterFastRange(uint32_t(hash >> 32), m_blocks.size())); }
+		FORCEINLINE Block const & blockFor  (uint64_t hash) const { return m_blocks[blockIndex(hash)]; }
+
+		FORCEINLINE static uint64_t bitFor(uint32_t key, size_t word) { return uint64_t(1) << ((key * Salt[word]) >> 26); }
+
+		static bool probeScalar(Block const & b, uint32_t key)
+		{
+			uint64_t missing = 0;
+			for (size_t w = 0; w < WordsPerBlock; w++)
+				missing |= bitFor(key, w) & ~b.Words[w];
+			return missing == 0;
+		}
+
+		static void containsManyScalar(BloomFilter const & f, uint64_t const * hashes, size_t n, bool * out)
+		{
+			for (size_t i = 0; i < n; i++)
+				out[i] = probeScalar(f.blockFor(hashes[i]), uint32_t(hashes[i]));
+		}
+
+		#if defined IS_X64
+			TARGET_ISA("avx2") static void containsManyAVX2(BloomFilter const & f, uint64_t const * hashes, size_t n, bool * out)
+			{
+				__m256i const salt = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(Salt));
+				__m256i const one  = _mm256_set1_epi64x(1);
+
+				for (size_t i = 0; i < n; i++)
+				{
+					/// Start fetching a few keys ahead, since each probe is one likely cache miss.
+					if (i + 8 < n)
+						_mm_prefetch(reinterpret_cast<char const *>(&f.blockFor(hashes[i + 8])), _MM_HINT_T0);
+
+					Block const & b = f.blockFor(hashes[i]);
+
+					__m256i const shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(int(uint32_t(hashes[i]))), salt), 26);
+					__m256i const lo     = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(shifts)));
+					__m256i const hi     = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(shifts, 1)));
+
+					__m256i const w0 = _mm256_load_si256(reinterpret_cast<__m256i const *>(b.Words));
+					__m256i const w1 = _mm256_load_si256(reinterpret_cast<__m256i const *>(b.Words + 4));
+
+					/// testc: (~w & mask) == 0, i.e. every bit of mask is set in w.
+					out[i] = _mm256_testc_si256(w0, lo) & _mm256_testc_si256(w1, hi);
+				}
+			}
+		#endif
+
+		/// False positive rate with keys spread over numBlocks. A block's key count j is Poisson with mean
+		/// keys / numBlocks; each of its 8 words then has a given bit set with chance 1 - (63/64)^j, and a
+		/// probe needs all 8 of its bits set. Only j within 12 standard deviations of the mean is summed, so
+		/// this costs O(sqrt(lambda)) whatever the key count.
+		static double expectedFalsePositiveRate(double keys, double numBlocks)
+		{
+			double const lambda = keys / numBlocks;
+			double const spread = 12.0 * std::sqrt(lambda) + 32.0;
+			size_t const jMin   = size_t(FastMax(lambda - spread, 1.0));
+			size_t const jMax   = size_t(lambda + spread);
+
+			double rate = 0.0;
+			for (size_t j = jMin; j <= jMax; j++)
+			{
+				double const poisson = std::exp(double(j) * std::log(lambda) - lambda - std::lgamma(double(j) + 1.0));
+				rate += poisson * std::pow(1.0 - std::pow(63.0 / 64.0, double(j)), double(WordsPerBlock));
+			}
+
+			return rate;
+		}
+
+		using ContainsManyFn = void (*)(BloomFilter const &, uint64_t const *, size_t, bool *);
+
+		static ContainsManyFn pickContainsMany()
+		{
+			#if defined IS_X64
+				CPUCapabilities const & cpu = CPUInfoCached();
+				if (cpu.AVX2 && cpu.OSAVX)
+					return containsManyAVX2;
+			#endif
+			return containsManyScalar;
+		}
+
+	public:
+		BloomFilter() = default;
+
+		/// Sized for expectedKeys at falsePositiveRate: the fewest blocks whose expected rate (for this
+		/// layout, not the textbook formula, which is off in both directions with k fixed at 8) is at
+		/// most falsePositiveRate.
+		explicit BloomFilter(uint64_t expectedKeys, double falsePositiveRate = 0.01)
+		{
+			double const keys   = double(FastMax(expectedKeys, 1_u64));
+			double const target = Clamp(falsePositiveRate, MinFalsePositiveRate, MaxFalsePositiveRate);
+
+			/// Bracket the answer around the textbook size, -n ln(p) / ln(2)^2 bits, which is within a small
+			/// factor of it, so the search takes a fixed number of steps rather than doubling up from 1 block.
+			double const   textbookBits   = -keys * std::log(target) / (std::log(2.0) * std::log(2.0));
+			uint64_t const textbookBlocks = uint64_t(std::ceil(textbookBits / double(BitsPerBlock)));
+
+			uint64_t lo = FastMax(textbookBlocks / 2, 1_u64);
+			uint64_t hi = FastMax(textbookBlocks * 2, 1_u64);
+			while (lo > 1 && expectedFalsePositiveRate(keys, double(lo)) <= target)
+				lo /= 2;
+			while (expectedFalsePositiveRate(keys, double(hi)) > target)
+				hi *= 2;
+
+			while (lo < hi)
+			{
+				uint64_t const mid = lo + (hi - lo) / 2;
+				if (expectedFalsePositiveRate(keys, double(mid)) <= target)
+					hi = mid;
+				else
+					lo = mid + 1;
+			}
+
+			m_blocks.assign(size_t(lo), Block{});
+		}
+
+		void insert_hash(uint64_t hash)
+		{
+			Block &        b   = m_blocks[blockIndex(hash)];
+			uint32_t const key = uint32_t(hash);
+
+			for (size_t w = 0; w < WordsPerBlock; w++)
+				b.Words[w] |= bitFor(key, w);
+
+			m_count++;
+		}
+
+		bool contains_hash(uint64_t hash) const
+		{
+			return !m_blocks.empty() && probeScalar(blockFor(hash), uint32_t(hash));
+		}
+
+		/// out[i] = contains_hash(hashes[i]).
+		void contains_many(uint64_t const * hashes, size_t n, bool * out) const
+		{
+			static ContainsManyFn const fn = pickContainsMany();
+
+			if (m_blocks.empty())
+				std::fill(out, out + n, false);
+			else
+				fn(*this, hashes, n, out);
+		}
+
+		void insert  (void const * data, size_t size)       { insert_hash(detail::FilterBytesHash(data, size)); }
+		bool contains(void const * data, size_t size) const { return contains_hash(detail::FilterBytesHash(data, size)); }
+
+		template <typename TKey> void insert  (TKey const & key)       { insert_hash(detail::FilterKeyHash(key)); }
+		template <typename TKey> bool contains(TKey const & key) const { return contains_hash(detail::FilterKeyHash(key)); }
+
+		/// Adds everything in rhs. Both must have been built with the same size.
+		void merge(BloomFilter const & rhs)
+		{
+			if (rhs.m_blocks.size() != m_blocks.size())
+				throw std::invalid_argument("BloomFilter::merge - filters are different sizes.");
+
+			for (size_t i = 0; i < m_blocks.size(); i++)
+				for (size_t w = 0; w < WordsPerBlock; w++)
+					m_blocks[i].Words[w] |= rhs.m_blocks[i].Words[w];
+
+			m_count += rhs.m_count;
+		}
+
+		void clear()
+		{
+			std::fill(m_blocks.begin(), m_blocks.end(), Block{});
+			m_count = 0;
+		}
+
+		uint64_t count()      const { return m_count; } /// Inserts so far, counting repeats.
+		uint64_t size_bytes() const { return uint64_t(m_blocks.size()) * sizeof(Block); }
+		bool     empty()      const { return m_count == 0; }
+
+		template <class SerialOp> void serial(SerialOp & ser)
+		{
+			std::vector<uint64_t> words;
+			words.reserve(m_blocks.size() * WordsPerBlock);
+			for (Block const & b : m_blocks)
+				words.insert(words.end(), b.Words, b.Words + WordsPerBlock);
+
+			ser(m_count);
+			ser(words);
+
+			m_blocks.resize(words.size() / WordsPerBlock);
+			for (size_t i = 0; i < m_blocks.size(); i++)
+				std::copy(words.begin() + i * WordsPerBlock, words.begin() + (i + 1) * WordsPerBlock, m_blocks[i].Words);
+		}
+	};
+
+	///-----------------------------------------------
+	/// Cuckoo Filter
+	/// Approximate set that, unlike BloomFilter, supports erase(). Stores a 16-bit fingerprint per key in
+	/// one of two buckets of 4 slots; the second bucket is the first XOR a hash of the fingerprint, so
+	/// either can be found from the other when a fingerprint has to be kicked out to make room.
+	///
+	/// Fills to around 95% before insert() starts failing. A bucket probe compares all 4 fingerprints at
+	/// once inside one 64-bit word. False positive rate is about 8 / 65536, independent of size.
+	///
+	/// Only erase() keys that were inserted: erasing anything else can remove another key's fingerprint.
+	/// Inserting the same key twice stores it twice (up to 8 times), and it then takes as many erases.
+	class CuckooFilter
+	{
+	public:
+		static constexpr size_t SlotsPerBucket = 4;
+		static constexpr size_t MaxKicks       = 500;
+
+	private:
+		std::vector<uint64_t> m_buckets;         /// 4 x 16-bit fingerprints each, 0 = empty.
+		uint64_t              m_mask      = 0;   /// Bucket count - 1.
+		uint64_t              m_count     = 0;
+		uint64_t              m_rng       = 0x9E3779B97F4A7C15ULL;
+
+		/// A fingerprint evicted by a failed insert, kept so it isn't lost. Once set, the filter is full.
+		uint64_t              m_victimBucket = 0;
+		uint16_t              m_victimFp     = 0;
+
+		static FORCEINLINE uint16_t fingerprint(uint64_t hash)
+		{
+			uint16_t const fp = uint16_t(hash >> 48);
+			return fp ? fp : 1;
+		}
+
+		FORCEINLINE uint64_t altBucket(uint64_t bucket, uint16_t fp) const { return (bucket ^ (uint64_t(fp) * 0x5BD1E995ULL)) & m_mask; }
+
+		static FORCEINLINE uint16_t getSlot(uint64_t bucket, size_t slot) { return uint16_t(bucket >> (slot * 16)); }
+
+		static FORCEINLINE void setSlot(uint64_t & bucket, size_t slot, uint16_t fp)
+		{
+			bucket = (bucket & ~(0xFFFFULL << (slot * 16))) | (uint64_t(fp) << (slot * 16));
+		}
+
+		/// Slot of fp in the bucket, or SlotsPerBucket. Looks for 0 to find a free slot.
+		static FORCEINLINE size_t findSlot(uint64_t bucket, uint16_t fp)
+		{
+			/// Classic has-zero-lane test, on bucket XOR fp in every lane.
+			uint64_t const x = bucket ^ (uint64_t(fp) * 0x0001000100010001ULL);
+			uint64_t const z = (x - 0x0001000100010001ULL) & ~x & 0x8000800080008000ULL;
+			return z ? size_t(BitscanLSB(z)) / 16 : SlotsPerBucket;
+		}
+
+		bool tryPut(uint64_t bucket, uint16_t fp)
+		{
+			size_t const slot = findSlot(m_buckets[size_t(bucket)], 0);
+			if (slot == SlotsPerBucket)
+				return false;
+
+			setSlot(m_buckets[size_t(bucket)], slot, fp);
+			return true;
+		}
+
+		uint64_t nextRandom()
+		{
+			m_rng ^= m_rng << 13;
+			m_rng ^= m_rng >> 7;
+			m_rng ^= m_rng << 17;
+			return m_rng;
+		}
+
+	public:
+		CuckooFilter() = default;
+
+		/// Room for capacity keys at about 95% load.
+		explicit CuckooFilter(uint64_t capacity)
+		{
+			uint64_t const buckets = NextPowerOfTwo(FastMax(uint64_t(double(capacity) / (SlotsPerBucket * 0.95)) + 1, 1_u64));
+			m_buckets.assign(size_t(buckets), 0);
+			m_mask = buckets - 1;
+		}
+
+		/// False once the filter is full. The key is still added then (so no false negatives), but
+		/// further inserts will fail until something is erased.
+		bool insert_hash(uint64_t hash)
+		{
+			if (m_buckets.empty() || m_victimFp)
+				return false;
+
+			uint16_t const fp = fingerprint(hash);
+			uint64_t const i1 = hash & m_mask;
+			uint64_t const i2 = altBucket(i1, fp);
+
+			m_count++;
+
+			if (tryPut(i1, fp) || tryPut(i2, fp))
+				return true;
+
+			uint64_t bucket = (nextRandom() & 1) ? i1 : i2;
+			uint16_t cur    = fp;
+
+			for (size_t kick = 0; kick < MaxKicks; kick++)
+			{
+				size_t const   slot    = size_t(nextRandom() % SlotsPerBucket);
+				uint16_t const evicted = getSlot(m_buckets[size_t(bucket)], slot);
+
+				setSlot(m_buckets[size_t(bucket)], slot, cur);
+
+				cur    = evicted;
+				bucket = altBucket(bucket, cur);
+
+				if (tryPut(bucket, cur))
+					return true;
+			}
+
+			m_victimBucket = bucket;
+			m_victimFp     = cur;
+			return false;
+		}
+
+		bool contains_hash(uint64_t hash) const
+		{
+			if (m_buckets.empty())
+				return false;
+
+			uint16_t const fp = fingerprint(hash);
+			uint64_t const i1 = hash & m_mask;
+			uint64_t const i2 = altBucket(i1, fp);
+
+			return findSlot(m_buckets[size_t(i1)], fp) != SlotsPerBucket
+			    || findSlot(m_buckets[size_t(i2)], fp) != SlotsPerBucket
+			    || (m_victimFp == fp && (m_victimBucket == i1 || m_victimBucket == i2));
+		}
+
+		/// Returns false if no matching fingerprint was found.
+		bool erase_hash(uint64_t hash)
+		{
+			if (m_buckets.empty())
+				return false;
+
+			uint16_t const fp = fingerprint(hash);
+			uint64_t const i1 = hash & m_mask;
+			uint64_t const i2 = altBucket(i1, fp);
+
+			for (uint64_t bucket : { i1, i2 })
+			{
+				size_t const slot = findSlot(m_buckets[size_t(bucket)], fp);
+				if (slot == SlotsPerBucket)
+					continue;
+
+				setSlot(m_buckets[size_t(bucket)], slot, 0);
+				m_count--;
+
+				/// There's room now, so try to put the victim back.
+				if (m_victimFp)
+				{
+					uint16_t const vfp = m_victimFp;
+					m_victimFp = 0;
+					if (!tryPut(m_victimBucket, vfp) && !tryPut(altBucket(m_victimBucket, vfp), vfp))
+						m_victimFp = vfp;
+				}
+				return true;
+			}
+
+			if (m_victimFp == fp && (m_victimBucket == i1 || m_victimBucket == i2))
+			{
+				m_victimFp = 0;
+				m_count--;
+				return true;
+			}
+
+			return false;
+		}
+
+		bool insert  (void const * data, size_t size)       { return insert_hash  (detail::FilterBytesHash(data, size)); }
+		bool contains(void const * data, size_t size) const { return contains_hash(detail::FilterBytesHash(data, size)); }
+		bool erase   (void const * data, size_t size)       { return erase_hash   (detail::FilterBytesHash(data, size)); }
+
+		template <typename TKey> bool insert  (TKey const & key)       { return insert_hash  (detail::FilterKeyHash(key)); }
+		template <typename TKey> bool contains(TKey const & key) const { return contains_hash(detail::FilterKeyHash(key)); }
+		template <typename TKey> bool erase   (TKey const & key)       { return erase_hash   (detail::FilterKeyHash(key)); }
+
+		void clear()
+		{
+			std::fill(m_buckets.begin(), m_buckets.end(), 0);
+			m_count    = 0;
+			m_victimFp = 0;
+		}
+
+		uint64_t count()      const { return m_count; }
+		uint64_t capacity()   const { return uint64_t(m_buckets.size()) * SlotsPerBucket; }
+		double   load()       const { return m_buckets.empty() ? 0.0 : double(m_count) / double(capacity()); }
+		uint64_t size_bytes() const { return uint64_t(m_buckets.size()) * sizeof(uint64_t); }
+		bool     empty()      const { return m_count == 0; }
+		bool     full()       const { return m_victimFp != 0; }
+
+		template <class SerialOp> void serial(SerialOp & ser)
+		{
+			ser(m_buckets);
+			ser(m_count);
+			ser(m_victimBucket);
+			ser(m_victimFp);
+
+			m_mask = m_buckets.empty() ? 0 : uint64_t(m_buckets.size()) - 1;
+		}
+	};
+}
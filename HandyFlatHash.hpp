@@ -0,0 +1,777 @@
+
+/// ========================================================================
+/// UNLICENSE
+///
+/// This is free and unencumbered software released into the public domain.
+/// Anyone is free to copy, modify, publish, use, compile, sell, or
+/// distribute this software, either in source code form or as a compiled
+/// binary, for any purpose, commercial or non-commercial, and by any
+/// means.
+///
+/// In jurisdictions that recognize copyright laws, the author or authors
+/// of this software dedicate any and all copyright interest in the
+/// software to the public domain. We make this dedication for the benefit
+/// of the public at large and to the detriment of our heirs and
+/// successors. We intend this dedication to be an overt act of
+/// relinquishment in perpetuity of all present and future rights to this
+/// software under copyright law.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+/// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+/// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+/// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+/// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/// OTHER DEALINGS IN THE SOFTWARE.
+///
+/// For more information, please refer to <http://unlicense.org/>
+/// ========================================================================
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined __SSE2__ || defined IS_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+	#define HANDY_FLATHASH_SSE2
+	#include <emmintrin.h>
+#endif
+
+#include "HandyBase.hpp"
+#include "HandyCompat.hpp"
+#include "HandyHash.hpp"
+#include "HandyUtils.hpp"
+
+namespace HANDY_NS {
+
+	namespace detail
+	{
+		struct FlatStringHash
+		{
+			using is_transparent = void;
+
+			size_t operator()(std::string_view s) const { return size_t(Hash::XXHash64::Hash(s.data(), s.size())); }
+		};
+
+		template <typename H, typename = void> struct FlatIsTransparent                                            : std::false_type {};
+		template <typename H>                  struct FlatIsTransparent<H, std::void_t<typename H::is_transparent>> : std::true_type  {};
+
+		/// An alias straight to K, rather than through std::conditional, so that K stays deducible.
+		template <bool Transparent> struct FlatKeyArg        { template <typename K, typename TKey> using type = K;    };
+		template <>                 struct FlatKeyArg<false> { template <typename K, typename TKey> using type = TKey; };
+	}
+
+	///-----------------------------------------------
+	/// Flat Hash
+	/// Default hasher for FlatHashMap and FlatHashSet. Scalars and strings are hashed with XXHash64.
+	/// Anything else goes through std::hash first, then XXHash64's finalizer, since the table takes
+	/// its 7 bit tags from the low bits and std::hash is often the identity.
+	template <typename T, typename = void>
+	struct FlatHash
+	{
+		size_t operator()(T const & v) const { return size_t(Hash::XXHash64::HashWord(uint64_t(std::hash<T>{}(v)))); }
+	};
+
+	template <typename T>
+	struct FlatHash<T, std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>>>
+	{
+		size_t operator()(T v) const
+		{
+			if constexpr (std::is_pointer_v<T>)
+				return size_t(Hash::XXHash64::HashWord(uint64_t(uintptr_t(v))));
+			else
+				return size_t(Hash::XXHash64::HashWord(uint64_t(v)));
+		}
+	};
+
+	template <> struct FlatHash<std::string>      : detail::FlatStringHash {};
+	template <> struct FlatHash<std::string_view> : detail::FlatStringHash {};
+
+	/// Default key equality. Transparent for strings, so FlatHashMap<std::string, ...> can be searched
+	/// with a string_view or a char const * without building a std::string.
+	template <typename T> struct FlatEq                   : std::equal_to<T> {};
+	template <>           struct FlatEq<std::string>      : std::equal_to<>  {};
+	template <>           struct FlatEq<std::string_view> : std::equal_to<>  {};
+
+	namespace detail
+	{
+		/// Control bytes. A full slot stores the low 7 bits of its hash (H2), so it is never negative.
+		using FlatCtrl = int8_t;
+
+		static constexpr FlatCtrl CtrlEmpty   = -128;
+		static constexpr FlatCtrl CtrlDeleted = -2;
+
+		/// 16 control bytes, compared at once. Bit i of each mask is byte i.
+		struct FlatGroup
+		{
+			static constexpr size_t Width = 16;
+
+			#if defined HANDY_FLATHASH_SSE2
+				__m128i m_ctrl;
+
+				explicit FlatGroup(FlatCtrl const * p) : m_ctrl(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p))) { }
+
+				uint32_t Match(uint8_t h2)        const { return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(char(h2)), m_ctrl))); }
+				uint32_t MatchEmpty()             const { return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(CtrlEmpty), m_ctrl))); }
+				uint32_t MatchEmptyOrDeleted()    const { return uint32_t(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), m_ctrl))); }
+			#else
+				FlatCtrl m_ctrl[Width];
+
+				explicit FlatGroup(FlatCtrl const * p) { std::memcpy(m_ctrl, p, Width); }
+
+				uint32_t Match(uint8_t h2) const
+				{
+					uint32_t mask = 0;
+					for (size_t i = 0; i < Width; i++)
+						mask |= uint32_t(m_ctrl[i] == FlatCtrl(h2)) << i;
+					return mask;
+				}
+
+				uint32_t MatchEmpty() const
+				{
+					uint32_t mask = 0;
+					for (size_t i = 0; i < Width; i++)
+						mask |= uint32_t(m_ctrl[i] == CtrlEmpty) << i;
+					return mask;
+				}
+
+				uint32_t MatchEmptyOrDeleted() const
+				{
+					uint32_t mask = 0;
+					for (size_t i = 0; i < Width; i++)
+						mask |= uint32_t(m_ctrl[i] < -1) << i;
+					return mask;
+				}
+			#endif
+
+			uint32_t MatchFull() const { return ~MatchEmptyOrDeleted() & 0xFFFFu; }
+		};
+
+		/// Index of the highest set bit of a nonzero 16 bit mask.
+		FORCEINLINE uint32_t FlatHighestBit(uint32_t mask)
+		{
+			#if defined IS_WINDOWS
+				unsigned long result = 0;
+				_BitScanReverse(&result, mask);
+				return uint32_t(result);
+			#else
+				return 31u - uint32_t(__builtin_clz(mask));
+			#endif
+		}
+
+		///-----------------------------------------------
+		/// Flat Hash Table
+		/// The open addressing table behind FlatHashMap and FlatHashSet, after Google's SwissTable. Each
+		/// slot has one control byte: empty, deleted, or the 7 bit H2 tag of the hash. Lookups probe a
+		/// group of 16 control bytes at a time, and only compare keys whose tag matches, which is almost
+		/// never a false positive. The first 16 control bytes are cloned past the end, so a group can
+		/// start at any slot without wrapping.
+		///
+		/// Slots are stored inline, in one array. Capacity is a power of two, at least 16, and the table
+		/// grows at a load of 7/8. Pointers and iterators are stable until the table grows or rehashes.
+		template <typename TKey, typename TSlot, typename TPolicy, typename THash, typename TEq>
+		class FlatHashTable
+		{
+			static constexpr size_t Width = FlatGroup::Width;
+
+			FlatCtrl * m_ctrl       = nullptr;
+			TSlot    * m_slots      = nullptr;
+			size_t     m_capacity   = 0;
+			size_t     m_size       = 0;
+			size_t     m_growthLeft = 0;
+
+			THash m_hash;
+			TEq   m_eq;
+
+			static constexpr size_t maxLoad(size_t capacity) { return capacity - capacity / 8; }
+
+			size_t mask() const { return m_capacity - 1; }
+
+			static uint8_t h2(size_t hash) { return uint8_t(hash & 0x7F); }
+
+			void setCtrl(size_t i, FlatCtrl c)
+			{
+				m_ctrl[i] = c;
+				if (i < Width)
+					m_ctrl[m_capacity + i] = c;
+			}
+
+			/// First empty or deleted slot in the probe sequence of hash.
+			size_t findFirstNonFull(size_t hash) const
+			{
+				size_t pos  = (hash >> 7) & mask();
+				size_t step = 0;
+
+				for (;;)
+				{
+					uint32_t const free = FlatGroup(m_ctrl + pos).MatchEmptyOrDeleted();
+					if (free)
+						return (pos + BitscanLSB(free)) & mask();
+
+					step += Width;
+					pos   = (pos + step) & mask();
+				}
+			}
+
+			void resize(size_t nuCapacity)
+			{
+				FlatCtrl * oldCtrl     = m_ctrl;
+				TSlot    * oldSlots    = m_slots;
+				size_t     oldCapacity = m_capacity;
+
+				m_slots    = std::allocator<TSlot>().allocate(nuCapacity);
+				m_ctrl     = new FlatCtrl[nuCapacity + Width];
+				m_capacity = nuCapacity;
+				std::memset(m_ctrl, CtrlEmpty, nuCapacity + Width);
+
+				for (size_t i = 0; i < oldCapacity; i++)
+				{
+					if (oldCtrl[i] < 0)
+						continue;
+
+					size_t const hash = m_hash(TPolicy::Key(oldSlots[i]));
+					size_t const dst  = findFirstNonFull(hash);
+
+					setCtrl(dst, FlatCtrl(h2(hash)));
+					new (m_slots + dst) TSlot(std::move(oldSlots[i]));
+					oldSlots[i].~TSlot();
+				}
+
+				m_growthLeft = maxLoad(m_capacity) - m_size;
+
+				if (oldSlots)
+				{
+					std::allocator<TSlot>().deallocate(oldSlots, oldCapacity);
+					delete [] oldCtrl;
+				}
+			}
+
+			/// Called when there is no growth left. If at least half the used slots are tombstones, they
+			/// are purged at the same capacity instead of doubling.
+			void rehashAndGrow()
+			{
+				if (m_capacity > Width && m_size <= maxLoad(m_capacity) / 2)
+					resize(m_capacity);
+				else
+					resize(m_capacity ? m_capacity * 2 : Width);
+			}
+
+			/// Claims a slot for a new key with the given hash, growing first if needed. The caller
+			/// constructs the slot, or calls abandonSlot if that throws.
+			size_t prepareInsert(size_t hash)
+			{
+				size_t idx = m_capacity ? findFirstNonFull(hash) : 0;
+
+				if (m_growthLeft == 0 && (m_capacity == 0 || m_ctrl[idx] != CtrlDeleted))
+				{
+					rehashAndGrow();
+					idx = findFirstNonFull(hash);
+				}
+
+				if (m_ctrl[idx] == CtrlEmpty)
+					--m_growthLeft;
+
+				setCtrl(idx, FlatCtrl(h2(hash)));
+				++m_size;
+				return idx;
+			}
+
+			void abandonSlot(size_t idx)
+			{
+				setCtrl(idx, CtrlDeleted);
+				--m_size;
+			}
+
+			void destroyAll()
+			{
+				if constexpr (!std::is_trivially_destructible_v<TSlot>)
+				{
+					for (size_t i = 0; i < m_capacity; i++)
+						if (m_ctrl[i] >= 0)
+							m_slots[i].~TSlot();
+				}
+			}
+
+		public:
+			using key_type   = TKey;
+			using value_type = TSlot;
+			using size_type  = size_t;
+			using hasher     = THash;
+			using key_equal  = TEq;
+
+			/// With a transparent hasher and equality, lookups take anything they accept, e.g. a string_view.
+			template <typename K>
+			using key_arg = typename FlatKeyArg<FlatIsTransparent<THash>::value && FlatIsTransparent<TEq>::value>::template type<K, TKey>;
+
+			template <typename TTable, typename TVal>
+			class iterator_base
+			{
+				friend class FlatHashTable;
+
+				TTable * m_table = nullptr;
+				size_t   m_index = 0;
+
+				void skipEmpty()
+				{
+					size_t const capacity = m_table->m_capacity;
+
+					while (m_index < capacity)
+					{
+						uint32_t const full = FlatGroup(m_table->m_ctrl + m_index).MatchFull();
+						if (full)
+						{
+							m_index += BitscanLSB(full);
+							if (m_index > capacity)
+								m_index = capacity;
+							return;
+						}
+						m_index += Width;
+					}
+
+					m_index = capacity;
+				}
+
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type        = std::remove_const_t<TVal>;
+				using difference_type   = ptrdiff_t;
+				using pointer           = TVal *;
+				using reference         = TVal &;
+
+				iterator_base() = default;
+				iterator_base(TTable * table, size_t index) : m_table(table), m_index(index) { }
+
+				/// iterator -> const_iterator
+				template <typename TOtherTable, typename TOtherVal, typename = std::enable_if_t<std::is_const_v<TVal> && !std::is_const_v<TOtherVal>>>
+				iterator_base(iterator_base<TOtherTable, TOtherVal> const & rhs) : m_table(rhs.table()), m_index(rhs.index()) { }
+
+				TTable * table() const { return m_table; }
+				size_t   index() const { return m_index; }
+
+				reference operator*()  const { return m_table->m_slots[m_index]; }
+				pointer   operator->() const { return &m_table->m_slots[m_index]; }
+
+				iterator_base & operator++()    { ++m_index; skipEmpty(); return *this; }
+				iterator_base   operator++(int) { iterator_base t = *this; ++*this; return t; }
+
+				bool operator==(iterator_base const & rhs) const { return m_index == rhs.m_index; }
+				bool operator!=(iterator_base const & rhs) const { return m_index != rhs.m_index; }
+			};
+
+			using iterator       = iterator_base<FlatHashTable,       TSlot>;
+			using const_iterator = iterator_base<FlatHashTable const, TSlot const>;
+
+			FlatHashTable() = default;
+
+			explicit FlatHashTable(size_t capacity, THash const & hash = THash(), TEq const & eq = TEq()) : m_hash(hash), m_eq(eq) { reserve(capacity); }
+
+			FlatHashTable(FlatHashTable const & rhs) : m_hash(rhs.m_hash), m_eq(rhs.m_eq)
+			{
+				reserve(rhs.m_size);
+				for (TSlot const & v : rhs)
+				{
+					size_t const idx = prepareInsert(m_hash(TPolicy::Key(v)));
+					try                { new (m_slots + idx) TSlot(v); }
+					catch (...)        { abandonSlot(idx); throw; }
+				}
+			}
+
+			FlatHashTable(FlatHashTable && rhs) noexcept : m_hash(rhs.m_hash), m_eq(rhs.m_eq) { swap(rhs); }
+
+			FlatHashTable & operator=(FlatHashTable rhs) noexcept
+			{
+				swap(rhs);
+				return *this;
+			}
+
+			~FlatHashTable()
+			{
+				if (!m_slots)
+					return;
+
+				destroyAll();
+				std::allocator<TSlot>().deallocate(m_slots, m_capacity);
+				delete [] m_ctrl;
+			}
+
+			void swap(FlatHashTable & rhs) noexcept
+			{
+				std::swap(m_ctrl,       rhs.m_ctrl);
+				std::swap(m_slots,      rhs.m_slots);
+				std::swap(m_capacity,   rhs.m_capacity);
+				std::swap(m_size,       rhs.m_size);
+				std::swap(m_growthLeft, rhs.m_growthLeft);
+				std::swap(m_hash,       rhs.m_hash);
+				std::swap(m_eq,         rhs.m_eq);
+			}
+
+			/// Index of the slot holding key, or m_capacity.
+			template <typename K>
+			size_t findIndex(K const & key) const
+			{
+				if (m_size == 0)
+					return m_capacity;
+
+				size_t const  hash = m_hash(key);
+				uint8_t const tag  = h2(hash);
+				size_t        pos  = (hash >> 7) & mask();
+				size_t        step = 0;
+
+				for (;;)
+				{
+					FlatGroup const group(m_ctrl + pos);
+
+					for (uint32_t match = group.Match(tag); match; match &= match - 1)
+					{
+						size_t const idx = (pos + BitscanLSB(match)) & mask();
+						if (m_eq(TPolicy::Key(m_slots[idx]), key))
+							return idx;
+					}
+
+					if (group.MatchEmpty())
+						return m_capacity;
+
+					step += Width;
+					pos   = (pos + step) & mask();
+				}
+			}
+
+			/// Returns the slot index for key, and true if the caller has to construct it (with the
+			/// slot's ctrl already set, so the caller must abandonSlot on failure).
+			template <typename K>
+			std::pair<size_t, bool> findOrPrepareInsert(K const & key)
+			{
+				size_t const idx = findIndex(key);
+				if (idx != m_capacity)
+					return { idx, false };
+
+				return { prepareInsert(m_hash(key)), true };
+			}
+
+			template <typename K, typename... Args>
+			std::pair<iterator, bool> emplaceKey(K const & key, Args &&... args)
+			{
+				auto [idx, inserted] = findOrPrepareInsert(key);
+				if (inserted)
+				{
+					try         { new (m_slots + idx) TSlot(std::forward<Args>(args)...); }
+					catch (...) { abandonSlot(idx); throw; }
+				}
+				return { iterator(this, idx), inserted };
+			}
+
+			void eraseIndex(size_t idx)
+			{
+				assert(m_ctrl[idx] >= 0);
+
+				m_slots[idx].~TSlot();
+				--m_size;
+
+				/// If no group containing idx has ever been full, no probe has ever skipped past it, so
+				/// it can go straight back to empty, rather than leaving a tombstone.
+				uint32_t const emptyBefore = FlatGroup(m_ctrl + ((idx - Width) & mask())).MatchEmpty();
+				uint32_t const emptyAfter  = FlatGroup(m_ctrl + idx).MatchEmpty();
+
+				bool const wasNeverFull = emptyBefore && emptyAfter &&
+					(Width - 1 - FlatHighestBit(emptyBefore)) + BitscanLSB(emptyAfter) < Width;
+
+				if (wasNeverFull)
+				{
+					setCtrl(idx, CtrlEmpty);
+					++m_growthLeft;
+				}
+				else
+				{
+					setCtrl(idx, CtrlDeleted);
+				}
+			}
+
+			TSlot       & slotAt(size_t idx)       { return m_slots[idx]; }
+			TSlot const & slotAt(size_t idx) const { return m_slots[idx]; }
+
+			void clear()
+			{
+				if (m_size == 0)
+					return;
+
+				destroyAll();
+				std::memset(m_ctrl, CtrlEmpty, m_capacity + Width);
+				m_size       = 0;
+				m_growthLeft = maxLoad(m_capacity);
+			}
+
+			/// Makes room for n elements without growing.
+			void reserve(size_t n)
+			{
+				if (n <= m_size + m_growthLeft)
+					return;
+
+				size_t nuCapacity = size_t(NextPowerOfTwo(uint64_t(n + n / 7 + 1)));
+				if (nuCapacity < Width)
+					nuCapacity = Width;
+
+				resize(nuCapacity);
+			}
+
+			/// Rehashes into the smallest capacity that fits n elements (and the current ones), which also
+			/// drops all tombstones.
+			void rehash(size_t n)
+			{
+				if (n < m_size)
+					n = m_size;
+
+				if (n == 0 && m_capacity)
+				{
+					FlatHashTable().swap(*this);
+					return;
+				}
+
+				size_t nuCapacity = size_t(NextPowerOfTwo(uint64_t(n + n / 7 + 1)));
+				if (nuCapacity < Width)
+					nuCapacity = Width;
+
+				resize(nuCapacity);
+			}
+
+			size_t size()        const { return m_size; }
+			bool   empty()       const { return m_size == 0; }
+			size_t capacity()    const { return m_capacity; }
+			float  load_factor() const { return m_capacity ? float(m_size) / float(m_capacity) : 0.0f; }
+
+			hasher    hash_function() const { return m_hash; }
+			key_equal key_eq()        const { return m_eq; }
+
+			iterator       begin()        { iterator       it(this, 0); if (m_capacity) it.skipEmpty(); return it; }
+			iterator       end()          { return iterator      (this, m_capacity); }
+			const_iterator begin()  const { const_iterator it(this, 0); if (m_capacity) it.skipEmpty(); return it; }
+			const_iterator end()    const { return const_iterator(this, m_capacity); }
+			const_iterator cbegin() const { return begin(); }
+			const_iterator cend()   const { return end();   }
+		};
+
+		struct FlatMapPolicy
+		{
+			template <typename TPair> static auto const & Key(TPair const & p) { return p.first; }
+		};
+
+		struct FlatSetPolicy
+		{
+			template <typename T> static T const & Key(T const & v) { return v; }
+		};
+	}
+
+	///-----------------------------------------------
+	/// Flat Hash Map
+	/// Open addressing hash map with SIMD probing (see detail::FlatHashTable). Interface follows
+	/// std::unordered_map, minus buckets and node handles. Elements are std::pair<TKey, TVal> stored
+	/// inline in the table, so references are invalidated when it grows, and keys must not be modified
+	/// through an iterator.
+	template <typename TKey, typename TVal, typename THash = FlatHash<TKey>, typename TEq = FlatEq<TKey>>
+	class FlatHashMap : public detail::FlatHashTable<TKey, std::pair<TKey, TVal>, detail::FlatMapPolicy, THash, TEq>
+	{
+		using Base = detail::FlatHashTable<TKey, std::pair<TKey, TVal>, detail::FlatMapPolicy, THash, TEq>;
+
+		template <typename K> using key_arg = typename Base::template key_arg<K>;
+
+	public:
+		using mapped_type    = TVal;
+		using value_type     = std::pair<TKey, TVal>;
+		using iterator       = typename Base::iterator;
+		using const_iterator = typename Base::const_iterator;
+
+		using Base::Base;
+
+		FlatHashMap() = default;
+
+		FlatHashMap(std::initializer_list<value_type> init)
+		{
+			this->reserve(init.size());
+			for (value_type const & v : init)
+				insert(v);
+		}
+
+		template <typename K = TKey>
+		iterator find(key_arg<K> const & key)
+		{
+			return iterator(this, this->findIndex(key));
+		}
+
+		template <typename K = TKey>
+		const_iterator find(key_arg<K> const & key) const
+		{
+			return const_iterator(this, this->findIndex(key));
+		}
+
+		template <typename K = TKey> bool   contains(key_arg<K> const & key) const { return this->findIndex(key) != this->capacity(); }
+		template <typename K = TKey> size_t count   (key_arg<K> const & key) const { return contains(key) ? 1 : 0; }
+
+		template <typename K = TKey>
+		TVal & at(key_arg<K> const & key)
+		{
+			size_t const idx = this->findIndex(key);
+			if (idx == this->capacity())
+				throw std::out_of_range("FlatHashMap::at");
+			return this->slotAt(idx).second;
+		}
+
+		template <typename K = TKey>
+		TVal const & at(key_arg<K> const & key) const
+		{
+			size_t const idx = this->findIndex(key);
+			if (idx == this->capacity())
+				throw std::out_of_range("FlatHashMap::at");
+			return this->slotAt(idx).second;
+		}
+
+		/// Constructs the value from args only if key is not present.
+		template <typename K = TKey, typename... Args>
+		std::pair<iterator, bool> try_emplace(key_arg<K> const & key, Args &&... args)
+		{
+			return this->emplaceKey(key, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+		}
+
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(TKey && key, Args &&... args)
+		{
+			return this->emplaceKey(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+		}
+
+		std::pair<iterator, bool> insert(value_type const & v) { return this->emplaceKey(v.first, v); }
+		std::pair<iterator, bool> insert(value_type &&      v) { return this->emplaceKey(v.first, std::move(v)); }
+
+		template <typename TIter>
+		void insert(TIter first, TIter last)
+		{
+			for (; first != last; ++first)
+				insert(*first);
+		}
+
+		/// Constructs the pair up front, to find its key.
+		template <typename... Args>
+		std::pair<iterator, bool> emplace(Args &&... args)
+		{
+			return insert(value_type(std::forward<Args>(args)...));
+		}
+
+		template <typename V>
+		std::pair<iterator, bool> insert_or_assign(TKey const & key, V && v)
+		{
+			auto result = try_emplace(key, std::forward<V>(v));
+			if (!result.second)
+				result.first->second = std::forward<V>(v);
+			return result;
+		}
+
+		template <typename K = TKey>
+		TVal & operator[](key_arg<K> const & key) { return try_emplace(key).first->second; }
+		TVal & operator[](TKey &&            key) { return try_emplace(std::move(key)).first->second; }
+
+		template <typename K = TKey>
+		size_t erase(key_arg<K> const & key)
+		{
+			size_t const idx = this->findIndex(key);
+			if (idx == this->capacity())
+				return 0;
+
+			this->eraseIndex(idx);
+			return 1;
+		}
+
+		/// Returns the iterator after it. Erasing never moves other elements.
+		iterator erase(const_iterator it)
+		{
+			this->eraseIndex(it.index());
+			iterator next(this, it.index());
+			return ++next;
+		}
+
+		iterator erase(iterator it) { return erase(const_iterator(it)); }
+	};
+
+	///-----------------------------------------------
+	/// Flat Hash Set
+	/// FlatHashMap without the values.
+	template <typename TKey, typename THash = FlatHash<TKey>, typename TEq = FlatEq<TKey>>
+	class FlatHashSet : public detail::FlatHashTable<TKey, TKey, detail::FlatSetPolicy, THash, TEq>
+	{
+		using Base = detail::FlatHashTable<TKey, TKey, detail::FlatSetPolicy, THash, TEq>;
+
+		template <typename K> using key_arg = typename Base::template key_arg<K>;
+
+	public:
+		using value_type     = TKey;
+		using iterator       = typename Base::const_iterator; /// Elements are keys, so never mutable.
+		using const_iterator = typename Base::const_iterator;
+
+		using Base::Base;
+
+		FlatHashSet() = default;
+
+		FlatHashSet(std::initializer_list<TKey> init)
+		{
+			this->reserve(init.size());
+			for (TKey const & v : init)
+				insert(v);
+		}
+
+		template <typename K = TKey>
+		const_iterator find(key_arg<K> const & key) const
+		{
+			return const_iterator(this, this->findIndex(key));
+		}
+
+		template <typename K = TKey> bool   contains(key_arg<K> const & key) const { return this->findIndex(key) != this->capacity(); }
+		template <typename K = TKey> size_t count   (key_arg<K> const & key) const { return contains(key) ? 1 : 0; }
+
+		std::pair<const_iterator, bool> insert(TKey const & key) { return this->emplaceKey(key, key); }
+		std::pair<const_iterator, bool> insert(TKey &&      key) { return this->emplaceKey(key, std::move(key)); }
+
+		template <typename TIter>
+		void insert(TIter first, TIter last)
+		{
+			for (; first != last; ++first)
+				insert(*first);
+		}
+
+		template <typename... Args>
+		std::pair<const_iterator, bool> emplace(Args &&... args)
+		{
+			return insert(TKey(std::forward<Args>(args)...));
+		}
+
+		template <typename K = TKey>
+		size_t erase(key_arg<K> const & key)
+		{
+			size_t const idx = this->findIndex(key);
+			if (idx == this->capacity())
+				return 0;
+
+			this->eraseIndex(idx);
+			return 1;
+		}
+
+		const_iterator erase(const_iterator it)
+		{
+			this->eraseIndex(it.index());
+			const_iterator next(this, it.index());
+			return ++next;
+		}
+
+		const_iterator begin()  const { return Base::begin(); }
+		const_iterator end()    const { return Base::end();   }
+	};
+	///-----------------------------------------------
+
+} // HANDY_NS
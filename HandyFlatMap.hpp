@@ -0,0 +1,415 @@
+
+/// ========================================================================
+/// UNLICENSE
+///
+/// This is free and unencumbered software released into the public domain.
+/// Anyone is free to copy, modify, publish, use, compile, sell, or
+/// distribute this software, either in source code form or as a compiled
+/// binary, for any purpose, commercial or non-commercial, and by any
+/// means.
+///
+/// In jurisdictions that recognize copyright laws, the author or authors
+/// of this software dedicate any and all copyright interest in the
+/// software to the public domain. We make this dedication for the benefit
+/// of the public at large and to the detriment of our heirs and
+/// successors. We intend this dedication to be an overt act of
+/// relinquishment in perpetuity of all present and future rights to this
+/// software under copyright law.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+/// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+/// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+/// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+/// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/// OTHER DEALINGS IN THE SOFTWARE.
+///
+/// For more information, please refer to <http://unlicense.org/>
+/// ========================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined IS_MSVC && (defined _M_X64 || defined _M_IX86)
+	#include <xmmintrin.h>
+#endif
+
+#include "HandyBase.hpp"
+#include "HandyCompat.hpp"
+
+namespace HANDY_NS {
+
+	namespace detail
+	{
+		FORCEINLINE void SortedPrefetch(void const * p)
+		{
+			#if defined IS_MSVC && (defined _M_X64 || defined _M_IX86)
+				_mm_prefetch(static_cast<char const *>(p), _MM_HINT_T0);
+			#elif !defined IS_MSVC
+				__builtin_prefetch(p);
+			#else
+				(void)p;
+			#endif
+		}
+	}
+
+	/// std::lower_bound, without the unpredictable branch. Each step halves the range with a conditional
+	/// move rather than a jump, so the loop runs exactly log2(n) times whatever the key is, and never
+	/// mispredicts. comp(element, value) as for std::lower_bound.
+	///
+	/// Since nothing is speculated past the compare any more, both possible next midpoints are
+	/// prefetched while the range is too big for the cache, or this would lose to std::lower_bound.
+	template <typename TIter, typename TValue, typename TComp>
+	TIter BranchlessLowerBound(TIter first, TIter last, TValue const & value, TComp comp)
+	{
+		size_t n = size_t(last - first);
+		if (n == 0)
+			return first;
+
+		size_t const prefetchAbove = 16384 / sizeof(*first);
+
+		while (n > 1)
+		{
+			size_t const half = n / 2;
+
+			if (n > prefetchAbove)
+			{
+				detail::SortedPrefetch(std::addressof(first[half / 2]));
+				detail::SortedPrefetch(std::addressof(first[half + half / 2]));
+			}
+
+			first = comp(first[half], value) ? first + half : first;
+			n -= half;
+		}
+
+		return first + (comp(*first, value) ? 1 : 0);
+	}
+
+	template <typename TIter, typename TValue>
+	TIter BranchlessLowerBound(TIter first, TIter last, TValue const & value)
+	{
+		return BranchlessLowerBound(first, last, value, std::less<>());
+	}
+
+	namespace detail
+	{
+		template <typename C, typename = void> struct SortedIsTransparent                                            : std::false_type {};
+		template <typename C>                  struct SortedIsTransparent<C, std::void_t<typename C::is_transparent>> : std::true_type  {};
+
+		/// An alias straight to K, rather than through std::conditional, so that K stays deducible.
+		template <bool Transparent> struct SortedKeyArg        { template <typename K, typename TKey> using type = K;    };
+		template <>                 struct SortedKeyArg<false> { template <typename K, typename TKey> using type = TKey; };
+
+		///-----------------------------------------------
+		/// Sorted Vector
+		/// The storage behind FlatMap and FlatSet: one std::vector, sorted by key, with no duplicate
+		/// keys. Lookups are a BranchlessLowerBound over contiguous memory. Single inserts and erases
+		/// shift the tail, so are O(n); build with assign_unsorted or the range insert instead.
+		template <typename TKey, typename TValue, typename TPolicy, typename TLess>
+		class SortedVector
+		{
+		protected:
+			std::vector<TValue> m_data;
+			TLess               m_less;
+
+			struct ValueLess
+			{
+				TLess const & Less;
+
+				bool operator()(TValue const & a, TValue const & b) const { return Less(TPolicy::Key(a), TPolicy::Key(b)); }
+			};
+
+			/// Sorts, then drops all but the first of each run of equal keys.
+			void sortAndUnique(typename std::vector<TValue>::iterator from)
+			{
+				ValueLess const less{ m_less };
+
+				std::stable_sort(from, m_data.end(), less);
+				if (from != m_data.begin())
+					std::inplace_merge(m_data.begin(), from, m_data.end(), less);
+
+				auto const last = std::unique(m_data.begin(), m_data.end(), [&](TValue const & a, TValue const & b) { return !less(a, b); });
+				m_data.erase(last, m_data.end());
+			}
+
+		public:
+			using key_type       = TKey;
+			using value_type     = TValue;
+			using size_type      = size_t;
+			using key_compare    = TLess;
+			using iterator       = typename std::vector<TValue>::iterator;
+			using const_iterator = typename std::vector<TValue>::const_iterator;
+
+			/// With a transparent comparison, lookups take anything it accepts, e.g. a string_view.
+			template <typename K>
+			using key_arg = typename SortedKeyArg<SortedIsTransparent<TLess>::value>::template type<K, TKey>;
+
+			SortedVector() = default;
+			explicit SortedVector(TLess const & less) : m_less(less) { }
+
+			/// Replaces the contents with range, sorting once. Where keys repeat, the first one wins, as
+			/// with std::map::insert.
+			template <typename TRange>
+			void assign_unsorted(TRange && range)
+			{
+				m_data.assign(std::begin(range), std::end(range));
+				sortAndUnique(m_data.begin());
+			}
+
+			/// Takes data as is. It must already be sorted by key, without duplicates.
+			void assign_sorted(std::vector<TValue> && data)
+			{
+				m_data = std::move(data);
+				assert(std::adjacent_find(m_data.begin(), m_data.end(), [&](TValue const & a, TValue const & b) { return !ValueLess{ m_less }(a, b); }) == m_data.end());
+			}
+
+			/// Appends the range, sorts the new part and merges it in: O((n + m) + m log m), rather than
+			/// O(n * m) for one insert at a time. Keys already present are kept.
+			template <typename TIter>
+			void insert(TIter first, TIter last)
+			{
+				size_t const oldSize = m_data.size();
+				m_data.insert(m_data.end(), first, last);
+				sortAndUnique(m_data.begin() + ptrdiff_t(oldSize));
+			}
+
+			template <typename K = TKey>
+			iterator lower_bound(key_arg<K> const & key)
+			{
+				return BranchlessLowerBound(m_data.begin(), m_data.end(), key, [this](TValue const & v, auto const & k) { return m_less(TPolicy::Key(v), k); });
+			}
+
+			template <typename K = TKey>
+			const_iterator lower_bound(key_arg<K> const & key) const
+			{
+				return BranchlessLowerBound(m_data.begin(), m_data.end(), key, [this](TValue const & v, auto const & k) { return m_less(TPolicy::Key(v), k); });
+			}
+
+			template <typename K = TKey>
+			iterator upper_bound(key_arg<K> const & key)
+			{
+				return std::upper_bound(m_data.begin(), m_data.end(), key, [this](auto const & k, TValue const & v) { return m_less(k, TPolicy::Key(v)); });
+			}
+
+			template <typename K = TKey>
+			const_iterator upper_bound(key_arg<K> const & key) const
+			{
+				return std::upper_bound(m_data.begin(), m_data.end(), key, [this](auto const & k, TValue const & v) { return m_less(k, TPolicy::Key(v)); });
+			}
+
+			template <typename K = TKey>
+			iterator find(key_arg<K> const & key)
+			{
+				iterator it = lower_bound<K>(key);
+				return it != m_data.end() && !m_less(key, TPolicy::Key(*it)) ? it : m_data.end();
+			}
+
+			template <typename K = TKey>
+			const_iterator find(key_arg<K> const & key) const
+			{
+				const_iterator it = lower_bound<K>(key);
+				return it != m_data.end() && !m_less(key, TPolicy::Key(*it)) ? it : m_data.end();
+			}
+
+			template <typename K = TKey> bool   contains(key_arg<K> const & key) const { return find<K>(key) != m_data.end(); }
+			template <typename K = TKey> size_t count   (key_arg<K> const & key) const { return contains<K>(key) ? 1 : 0; }
+
+			template <typename K = TKey>
+			size_t erase(key_arg<K> const & key)
+			{
+				iterator it = find<K>(key);
+				if (it == m_data.end())
+					return 0;
+
+				m_data.erase(it);
+				return 1;
+			}
+
+			iterator erase(const_iterator it)                       { return m_data.erase(it); }
+			iterator erase(const_iterator first, const_iterator last) { return m_data.erase(first, last); }
+
+			void clear()            { m_data.clear(); }
+			void reserve(size_t n)  { m_data.reserve(n); }
+			void shrink_to_fit()    { m_data.shrink_to_fit(); }
+
+			size_t size()     const { return m_data.size(); }
+			bool   empty()    const { return m_data.empty(); }
+			size_t capacity() const { return m_data.capacity(); }
+
+			key_compare key_comp() const { return m_less; }
+
+			/// The sorted contents, e.g. to serialize, or to hand back to assign_sorted.
+			std::vector<TValue> const & sequence() const { return m_data; }
+			std::vector<TValue>         extract()        { return std::move(m_data); }
+
+			TValue const * data() const { return m_data.data(); }
+
+			iterator       begin()        { return m_data.begin(); }
+			iterator       end()          { return m_data.end();   }
+			const_iterator begin()  const { return m_data.begin(); }
+			const_iterator end()    const { return m_data.end();   }
+			const_iterator cbegin() const { return m_data.begin(); }
+			const_iterator cend()   const { return m_data.end();   }
+
+			bool operator==(SortedVector const & rhs) const { return m_data == rhs.m_data; }
+			bool operator!=(SortedVector const & rhs) const { return m_data != rhs.m_data; }
+		};
+
+		struct SortedMapPolicy
+		{
+			template <typename TPair> static auto const & Key(TPair const & p) { return p.first; }
+		};
+
+		struct SortedSetPolicy
+		{
+			template <typename T> static T const & Key(T const & v) { return v; }
+		};
+	}
+
+	///-----------------------------------------------
+	/// Flat Map
+	/// Sorted std::vector<std::pair<TKey, TVal>> with a std::map interface. For lookup tables that are
+	/// built once and then read many times: no per-node allocations, a third of the memory of a
+	/// std::map or less, and lookups walk contiguous memory. Keys must not be modified through an
+	/// iterator.
+	template <typename TKey, typename TVal, typename TLess = std::less<TKey>>
+	class FlatMap : public detail::SortedVector<TKey, std::pair<TKey, TVal>, detail::SortedMapPolicy, TLess>
+	{
+		using Base = detail::SortedVector<TKey, std::pair<TKey, TVal>, detail::SortedMapPolicy, TLess>;
+
+		template <typename K> using key_arg = typename Base::template key_arg<K>;
+
+	public:
+		using mapped_type    = TVal;
+		using value_type     = std::pair<TKey, TVal>;
+		using iterator       = typename Base::iterator;
+		using const_iterator = typename Base::const_iterator;
+
+		using Base::Base;
+		using Base::insert;
+
+		FlatMap() = default;
+
+		FlatMap(std::initializer_list<value_type> init) { this->assign_unsorted(init); }
+
+		template <typename K = TKey>
+		TVal & at(key_arg<K> const & key)
+		{
+			iterator it = this->template find<K>(key);
+			if (it == this->end())
+				throw std::out_of_range("FlatMap::at");
+			return it->second;
+		}
+
+		template <typename K = TKey>
+		TVal const & at(key_arg<K> const & key) const
+		{
+			const_iterator it = this->template find<K>(key);
+			if (it == this->end())
+				throw std::out_of_range("FlatMap::at");
+			return it->second;
+		}
+
+		/// Constructs the value from args only if key is not present. O(n) when it inserts.
+		template <typename K = TKey, typename... Args>
+		std::pair<iterator, bool> try_emplace(key_arg<K> const & key, Args &&... args)
+		{
+			iterator it = this->template lower_bound<K>(key);
+			if (it != this->end() && !this->m_less(key, it->first))
+				return { it, false };
+
+			it = this->m_data.emplace(it, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+			return { it, true };
+		}
+
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(TKey && key, Args &&... args)
+		{
+			iterator it = this->lower_bound(key);
+			if (it != this->end() && !this->m_less(key, it->first))
+				return { it, false };
+
+			it = this->m_data.emplace(it, std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+			return { it, true };
+		}
+
+		std::pair<iterator, bool> insert(value_type const & v) { return try_emplace(v.first, v.second); }
+		std::pair<iterator, bool> insert(value_type &&      v) { return try_emplace(std::move(v.first), std::move(v.second)); }
+
+		template <typename... Args>
+		std::pair<iterator, bool> emplace(Args &&... args) { return insert(value_type(std::forward<Args>(args)...)); }
+
+		template <typename V>
+		std::pair<iterator, bool> insert_or_assign(TKey const & key, V && v)
+		{
+			auto result = try_emplace(key, std::forward<V>(v));
+			if (!result.second)
+				result.first->second = std::forward<V>(v);
+			return result;
+		}
+
+		template <typename K = TKey>
+		TVal & operator[](key_arg<K> const & key) { return try_emplace<K>(key).first->second; }
+		TVal & operator[](TKey &&            key) { return try_emplace(std::move(key)).first->second; }
+	};
+
+	///-----------------------------------------------
+	/// Flat Set
+	/// FlatMap without the values.
+	template <typename TKey, typename TLess = std::less<TKey>>
+	class FlatSet : public detail::SortedVector<TKey, TKey, detail::SortedSetPolicy, TLess>
+	{
+		using Base = detail::SortedVector<TKey, TKey, detail::SortedSetPolicy, TLess>;
+
+		template <typename K> using key_arg = typename Base::template key_arg<K>;
+
+	public:
+		using value_type     = TKey;
+		using iterator       = typename Base::const_iterator; /// Elements are keys, so never mutable.
+		using const_iterator = typename Base::const_iterator;
+
+		using Base::Base;
+		using Base::insert;
+
+		FlatSet() = default;
+
+		FlatSet(std::initializer_list<TKey> init) { this->assign_unsorted(init); }
+
+		std::pair<const_iterator, bool> insert(TKey const & key) { return emplaceKey(key); }
+		std::pair<const_iterator, bool> insert(TKey &&      key) { return emplaceKey(std::move(key)); }
+
+		template <typename... Args>
+		std::pair<const_iterator, bool> emplace(Args &&... args) { return insert(TKey(std::forward<Args>(args)...)); }
+
+		template <typename K = TKey> const_iterator find       (key_arg<K> const & key) const { return Base::template find       <K>(key); }
+		template <typename K = TKey> const_iterator lower_bound(key_arg<K> const & key) const { return Base::template lower_bound<K>(key); }
+		template <typename K = TKey> const_iterator upper_bound(key_arg<K> const & key) const { return Base::template upper_bound<K>(key); }
+
+		const_iterator begin() const { return Base::begin(); }
+		const_iterator end()   const { return Base::end();   }
+
+	private:
+		template <typename K>
+		std::pair<const_iterator, bool> emplaceKey(K && key)
+		{
+			auto it = Base::template lower_bound<TKey>(key);
+			if (it != this->m_data.end() && !this->m_less(key, *it))
+				return { it, false };
+
+			return { this->m_data.insert(it, std::forward<K>(key)), true };
+		}
+	};
+	///-----------------------------------------------
+
+} // HANDY_NS
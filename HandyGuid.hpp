@@ -199,6 +199,21 @@ namespace HANDY_NS {
 
 }
 
+namespace HANDY_NS
+{
+	/// XXHash64 of the 16 bytes, for FlatHashMap/FlatHashSet.
+	template <>
+	struct FlatHash<Guid>
+	{
+		size_t operator()(Guid const & guid) const
+		{
+			uint64_t p[2];
+			std::memcpy(p, guid.Bytes.data(), sizeof(p));
+			return size_t(Hash::XXHash64::HashWords(p[0], p[1]));
+		}
+	};
+}
+
 namespace std
 {
 	template<>
@@ -207,15 +222,15 @@ namespace std
 		std::swap(lhs.Bytes, rhs.Bytes);
 	}
 
-	// Specialization for std::hash<Guid> -- this implementation uses std::hash<std::string> on the 
-	// stringification of the guid to calculate the hash
+	// Specialization for std::hash<Guid> -- XXHash64 of the 16 bytes, same as FlatHash<Guid>.
 	template <>
 	struct hash<HANDY_NS::Guid>
 	{
 		std::size_t operator()(HANDY_NS::Guid const &guid) const
 		{
-			const uint64_t* p = reinterpret_cast<const uint64_t*>(guid.Bytes.data());
-			return HANDY_NS::details::hash<uint64_t, uint64_t>{}(p[0], p[1]);
+			uint64_t p[2];
+			std::memcpy(p, guid.Bytes.data(), sizeof(p));
+			return size_t(HANDY_NS::Hash::XXHash64::HashWords(p[0], p[1]));
 		}
 	};
 
@@ -34,6 +34,11 @@
 #include <memory>
 #include <cstring>
 #include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+#include <atomic>
+#include <array>
 
 //Handy Includes
 #include "HandyBase.hpp"
@@ -131,6 +136,34 @@ namespace HANDY_NS {
 
 	#if !defined IS_CLI
 
+	///-----------------------------------------------
+	/// Allocator Stats
+	/// Telemetry for PoolAllocator and MemoryPool, to size ITEMSPERARENA and TypicalBlockSizeBytes from data.
+	/// Only collected if HANDY_MEMORY_STATS is defined, otherwise Stats() returns all zeroes and costs nothing.
+	struct AllocatorStats
+	{
+		size_t BytesInUse      = 0; /// Bytes handed out and not yet freed (or reset).
+		size_t BytesReserved   = 0; /// Bytes held by the allocator, including MemoryPool's retained spare blocks.
+		size_t HighWaterBytes  = 0; /// Largest BytesInUse ever seen.
+		size_t NumBlocks       = 0; /// Arenas for PoolAllocator. Blocks, including spares, for MemoryPool.
+		size_t WastedTailBytes = 0; /// MemoryPool only, bytes at the ends of blocks that can no longer be handed out.
+
+		/// Number of allocations by size. Bucket i counts sizes in [2^i, 2^(i+1)), bucket 0 also counts zero.
+		std::array<size_t, 64> SizeHistogram{};
+
+		static size_t HistogramBucket(size_t numBytes)
+		{
+			size_t ret = 0;
+			while (numBytes > 1)
+			{
+				numBytes >>= 1;
+				++ret;
+			}
+			return ret;
+		}
+	};
+	///-----------------------------------------------
+
 	///-----------------------------------------------
 	/// Pool Allocator
 	/// For O(1) allocation times.
@@ -160,6 +193,13 @@ namespace HANDY_NS {
 		Slot  * m_freeList;
 		std::mutex m_mutex;
 
+		#if defined HANDY_MEMORY_STATS
+			size_t m_numArenas  = 1;
+			size_t m_itemsInUse = 0;
+			size_t m_highWater  = 0;
+			size_t m_numAllocs  = 0;
+		#endif
+
 		PoolAllocator(const PoolAllocator &) = delete;
 		PoolAllocator & operator=(const PoolAllocator &) = delete;
 
@@ -204,8 +244,17 @@ namespace HANDY_NS {
 				{
 					m_arena = new Arena(m_arena);
 					ret = reinterpret_cast<TYPE *>(m_arena->Data[0].Payload);
+
+					#if defined HANDY_MEMORY_STATS
+						++m_numArenas;
+					#endif
 				}
 
+				#if defined HANDY_MEMORY_STATS
+					++m_numAllocs;
+					m_highWater = FastMax(m_highWater, ++m_itemsInUse);
+				#endif
+
 				return ret;
 			}
 		}
@@ -226,6 +275,10 @@ namespace HANDY_NS {
 				Slot * slot = reinterpret_cast<Slot *>(reinterpret_cast<char *>(ptr) - offsetof(Slot, Payload));
 				slot->NextFree = m_freeList;
 				m_freeList = slot;
+
+				#if defined HANDY_MEMORY_STATS
+					--m_itemsInUse;
+				#endif
 			}
 		}
 
@@ -238,80 +291,445 @@ namespace HANDY_NS {
 
 			ptrR = nullptr;
 		}
+
+		AllocatorStats Stats()
+		{
+			AllocatorStats ret;
+
+			#if defined HANDY_MEMORY_STATS
+				Locked(m_mutex)
+				{
+					ret.BytesInUse     = m_itemsInUse * sizeof(TYPE);
+					ret.BytesReserved  = m_numArenas  * sizeof(Arena);
+					ret.HighWaterBytes = m_highWater  * sizeof(TYPE);
+					ret.NumBlocks      = m_numArenas;
+					ret.SizeHistogram[AllocatorStats::HistogramBucket(sizeof(TYPE))] = m_numAllocs;
+				}
+			#endif
+
+			return ret;
+		}
 	};
 	///-----------------------------------------------
 
+	namespace detail
+	{
+		/// OS page allocation, used for MemoryPool blocks. Implemented in src/HandyMemory.cpp.
+		/// Memory returned from PageAlloc is NOT zeroed by contract (it usually is on a first mapping, but 
+		/// recycled blocks hold whatever was last written to them).
+		size_t PageSize();
+		size_t HugePageSize();
+		size_t PageRoundUp(size_t sizeBytes, bool hugePages);
+
+		void * PageAlloc  (size_t sizeBytes, bool hugePages); /// sizeBytes must be from PageRoundUp! Returns nullptr on failure.
+		void   PageFree   (void * p, size_t sizeBytes);
+		void   PageDiscard(void * p, size_t sizeBytes);       /// Returns the physical pages to the OS, but keeps the address range valid.
+	}
+
 	/// Self-expanding memory pool that guarantees returned chunks will not move as long as the pool exists.
 	/// Allocates memory in TypicalBlockSizeBytes size chunks, but if you request a size larger than this, it 
 	/// will allocate a chunk of the requested size instead.
+	///
+	/// Blocks are mapped directly from the OS and are NOT zero-filled. On Reset(), blocks of the typical size are
+	/// kept for reuse (up to MaxRetainedBlocks of them), so a pool that is repeatedly filled and reset stops 
+	/// touching the OS allocator at all. Call Trim() to hand the physical memory of the retained blocks back 
+	/// to the OS without giving up their address space.
+	///
+	/// If UseHugePages is set, blocks are rounded up to (and aligned on) the huge page size and advised with 
+	/// MADV_HUGEPAGE on Linux. This is ignored on other platforms.
+	///
+	/// If ThreadChunkBytes is nonzero the pool runs in concurrent mode: each thread claims a private chunk of 
+	/// that size from the pool, and serves small Get/Allocate requests from it without locking, only taking 
+	/// the lock again when its chunk runs out. The unused tail of a thread's chunk is wasted until Reset().
 	class MemoryPool
 	{
 	public:
+		struct Block
+		{
+			std::byte *              Data    = nullptr;
+			size_t                   Size    = 0;
+			std::vector<std::byte> * Adopted = nullptr; /// If not null, this block's memory belongs to an adopted vector.
+		};
+
 		size_t TypicalBlockSizeBytes; // One Mebibyte by default
+		size_t MaxRetainedBlocks;     // Maximum number of blocks kept by Reset() for reuse. Unlimited by default.
+		bool   UseHugePages;
+		size_t ThreadChunkBytes = 0;  // Size of the per-thread chunks in concurrent mode, 0 to disable. 64 KiB is a good start.
 
 		/// TODO: Figure out how to make std::swap for MemoryPool be a friend function so I can make all these fields private:
 		std::mutex Mutex;
 
-		std::vector<std::vector<std::byte> *> Blocks;
+		std::vector<Block> Blocks;
+		std::vector<Block> SpareBlocks; /// Recycled blocks, all of typicalMapSize() bytes.
 
 		size_t BlockIndex = 0;
 		size_t ByteIndex  = 0;
 
 		bool Inited = false;
 
-		MemoryPool(size_t typicalBlockSizeBytes = 1'048'576) : TypicalBlockSizeBytes(typicalBlockSizeBytes) { }
+		MemoryPool(size_t typicalBlockSizeBytes = 1'048'576, size_t maxRetainedBlocks = std::numeric_limits<size_t>::max(), bool useHugePages = false) 
+			: TypicalBlockSizeBytes(typicalBlockSizeBytes)
+			, MaxRetainedBlocks    (maxRetainedBlocks)
+			, UseHugePages         (useHugePages) 
+		{ }
 
 		COPY_ASSIGN_MOVE_CTOR(MemoryPool, delete, delete, delete)
 
 	private:
+		/// Identifies the current contents of the pool for the thread chunk caches. Every pool, and every Reset() 
+		/// of a pool, gets a fresh one, so a stale thread chunk can never match.
+		static uint64_t nextId()
+		{
+			static std::atomic<uint64_t> s_nextId{ 1 };
+			return s_nextId.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		std::atomic<uint64_t> m_id{ nextId() };
+
+		struct ThreadChunk
+		{
+			uint64_t    PoolId = 0;
+			std::byte * Cur    = nullptr;
+			std::byte * End    = nullptr;
+		};
+
+		#if defined HANDY_MEMORY_STATS
+			/// Atomic, since concurrent mode allocations don't take the lock.
+			struct StatCounters
+			{
+				std::atomic<size_t> BytesInUse     { 0 };
+				std::atomic<size_t> HighWaterBytes { 0 };
+				std::atomic<size_t> WastedTailBytes{ 0 };
+				std::atomic<size_t> SizeHistogram[64] = {};
+			};
+
+			StatCounters m_stats;
+		#endif
+
+		void recordAlloc(size_t numBytes)
+		{
+			#if defined HANDY_MEMORY_STATS
+				size_t const inUse = m_stats.BytesInUse.fetch_add(numBytes, std::memory_order_relaxed) + numBytes;
+				size_t       high  = m_stats.HighWaterBytes.load(std::memory_order_relaxed);
+
+				while (inUse > high && !m_stats.HighWaterBytes.compare_exchange_weak(high, inUse, std::memory_order_relaxed)) { }
+
+				m_stats.SizeHistogram[AllocatorStats::HistogramBucket(numBytes)].fetch_add(1, std::memory_order_relaxed);
+			#else
+				(void)numBytes;
+			#endif
+		}
+
+		void recordWaste(size_t numBytes)
+		{
+			#if defined HANDY_MEMORY_STATS
+				m_stats.WastedTailBytes.fetch_add(numBytes, std::memory_order_relaxed);
+			#else
+				(void)numBytes;
+			#endif
+		}
+
+		static constexpr size_t ThreadChunkSlots = 4; /// How many pools each thread can hold a chunk in at once.
+
+		static ThreadChunk * threadChunks(size_t & victimOut)
+		{
+			thread_local ThreadChunk chunks[ThreadChunkSlots];
+			thread_local size_t      victim = 0;
+
+			victimOut = victim++ % ThreadChunkSlots;
+			return chunks;
+		}
+
+		static std::byte * bumpAligned(ThreadChunk & chunk, size_t numBytes, size_t alignment)
+		{
+			uintptr_t const cur     = reinterpret_cast<uintptr_t>(chunk.Cur);
+			uintptr_t const aligned = (cur + alignment - 1) & ~uintptr_t(alignment - 1);
+
+			if (aligned + numBytes > reinterpret_cast<uintptr_t>(chunk.End))
+				return nullptr;
+
+			chunk.Cur = reinterpret_cast<std::byte *>(aligned + numBytes);
+			return reinterpret_cast<std::byte *>(aligned);
+		}
+
+		bool fitsThreadChunk(size_t numBytes, size_t alignment) const
+		{
+			/// Big requests would waste most of a chunk, they take the lock instead.
+			return ThreadChunkBytes != 0 && numBytes + alignment <= ThreadChunkBytes / 4;
+		}
+
+		void * getConcurrent(size_t numBytes, size_t alignment)
+		{
+			uint64_t const id = m_id.load(std::memory_order_relaxed);
+
+			size_t        victim;
+			ThreadChunk * chunks = threadChunks(victim);
+
+			for (size_t i = 0; i < ThreadChunkSlots; i++)
+			{
+				if (chunks[i].PoolId == id)
+				{
+					if (std::byte * p = bumpAligned(chunks[i], numBytes, alignment))
+						return p;
+
+					victim = i;
+					break;
+				}
+			}
+
+			ThreadChunk & chunk = chunks[victim];
+
+			if (chunk.PoolId == id)
+				recordWaste(chunk.End - chunk.Cur);
+
+			Locked(Mutex)
+			{
+				size_t const chunkBytes = ThreadChunkBytes;
+				chunk.Cur    = reinterpret_cast<std::byte *>(getAlignedImpl(chunkBytes, 64));
+				chunk.End    = chunk.Cur + chunkBytes;
+				chunk.PoolId = m_id.load(std::memory_order_relaxed);
+			}
+
+			return bumpAligned(chunk, numBytes, alignment);
+		}
+
+		size_t typicalMapSize() const { return detail::PageRoundUp(TypicalBlockSizeBytes, UseHugePages); }
+
+		Block newBlock(size_t numBytes)
+		{
+			size_t mapSize = detail::PageRoundUp(numBytes, UseHugePages);
+
+			if (mapSize == typicalMapSize())
+			{
+				while (!SpareBlocks.empty())
+				{
+					Block spare = SpareBlocks.back();
+					SpareBlocks.pop_back();
+
+					if (spare.Size == mapSize) 
+						return spare;
+
+					detail::PageFree(spare.Data, spare.Size); /// TypicalBlockSizeBytes was changed since this was retained.
+				}
+			}
+
+			void * p = detail::PageAlloc(mapSize, UseHugePages);
+			if (!p)
+				throw std::bad_alloc();
+
+			return Block{ reinterpret_cast<std::byte *>(p), mapSize, nullptr };
+		}
+
+		void releaseBlock(Block const & block)
+		{
+			if (block.Adopted)
+				delete block.Adopted;
+			else if (block.Size == typicalMapSize() && SpareBlocks.size() < MaxRetainedBlocks)
+				SpareBlocks.push_back(block);
+			else
+				detail::PageFree(block.Data, block.Size);
+		}
+
 		void tryInit()
 		{
 			if (!Inited)
 			{
-				(Blocks.emplace_back() = new std::vector<std::byte>())->resize(TypicalBlockSizeBytes);
+				Blocks.push_back(newBlock(TypicalBlockSizeBytes));
 				Inited = true;
 			}
-
 		}
 
-	public:
+		void resetImpl()
+		{
+			for (Block const & block : Blocks)
+				releaseBlock(block);
 
-		void * Get(size_t numBytes)
+			Blocks.clear();
+			BlockIndex = 0;
+			ByteIndex  = 0;
+
+			Inited = false;
+			m_id.store(nextId(), std::memory_order_relaxed);
+
+			#if defined HANDY_MEMORY_STATS
+				m_stats.BytesInUse     .store(0, std::memory_order_relaxed);
+				m_stats.WastedTailBytes.store(0, std::memory_order_relaxed);
+			#endif
+		}
+
+		void * getFromNewBlock(size_t numBytes)
 		{
-			std::scoped_lock sLock(Mutex);
+			Block nuBlock = newBlock(FastMax(numBytes, TypicalBlockSizeBytes));
+
+			if (numBytes > TypicalBlockSizeBytes / 2)
+			{
+				/// Oversized requests get their own block, which is slotted in behind the current one.
+				Blocks.insert(Blocks.begin() + BlockIndex, nuBlock);
+				++BlockIndex;
+
+				recordWaste(nuBlock.Size - numBytes);
+			}
+			else
+			{
+				recordWaste(Blocks[BlockIndex].Size - ByteIndex);
+
+				Blocks.push_back(nuBlock);
+				++BlockIndex;
+				ByteIndex = numBytes;
+			}
+
+			return nuBlock.Data;
+		}
 
+		void * getImpl(size_t numBytes)
+		{
 			tryInit();
 
-			if (numBytes <= (Blocks[BlockIndex]->size() - ByteIndex))
+			if (numBytes <= (Blocks[BlockIndex].Size - ByteIndex))
 			{
-				void * ret = &(*Blocks[BlockIndex])[ByteIndex];
+				void * ret = Blocks[BlockIndex].Data + ByteIndex;
 				ByteIndex += numBytes;
 				return ret;
 			}
 
-			auto & nuBlock = *(Blocks.emplace_back(new std::vector<std::byte>()));
-			++BlockIndex;
+			return getFromNewBlock(numBytes);
+		}
 
-			if (numBytes > TypicalBlockSizeBytes / 2)
+		void * getAlignedImpl(size_t numBytes, size_t alignment)
+		{
+			tryInit();
+
+			uintptr_t const current = reinterpret_cast<uintptr_t>(Blocks[BlockIndex].Data + ByteIndex);
+			size_t    const padding = (alignment - (current & (alignment - 1))) & (alignment - 1);
+
+			if (padding + numBytes <= (Blocks[BlockIndex].Size - ByteIndex))
 			{
-				nuBlock.resize(numBytes);
-				std::swap(Blocks[BlockIndex], Blocks[BlockIndex -1]);
+				ByteIndex += padding + numBytes;
+				return reinterpret_cast<void *>(current + padding);
+			}
+
+			/// Fresh blocks are page aligned, so we only need slop for alignments larger than a page.
+			size_t    const slop  = alignment > detail::PageSize() ? alignment - 1 : 0;
+			uintptr_t const fresh = reinterpret_cast<uintptr_t>(getFromNewBlock(numBytes + slop));
+
+			return reinterpret_cast<void *>((fresh + alignment - 1) & ~uintptr_t(alignment - 1));
+		}
+
+		/// Intrusive list of destructors to run on Reset(), newest first. Each node lives in the pool, just in front of its objects.
+		struct DtorNode
+		{
+			DtorNode * Next;
+			void    (* Destroy)(void * objects, size_t count);
+			void *     Objects;
+			size_t     Count;
+		};
+
+		DtorNode * m_dtorHead = nullptr;
+
+		template <typename T>
+		static void destroyObjects(void * objects, size_t count)
+		{
+			T * typed = reinterpret_cast<T *>(objects);
+			while (count > 0)
+				typed[--count].~T();
+		}
+
+		/// Reserves room for count T's, preceded by a DtorNode if T needs destructing. Does not construct anything.
+		template <typename T>
+		T * allocateTracked(size_t count, DtorNode * & nodeOut)
+		{
+			if constexpr (std::is_trivially_destructible_v<T>)
+			{
+				nodeOut = nullptr;
+				return reinterpret_cast<T *>(Allocate(sizeof(T) * count, alignof(T)));
 			}
 			else
 			{
-				nuBlock.resize(TypicalBlockSizeBytes);
-				ByteIndex = numBytes;
+				constexpr size_t alignment  = alignof(T) > alignof(DtorNode) ? alignof(T) : alignof(DtorNode);
+				constexpr size_t nodeOffset = ((sizeof(DtorNode) + alignof(T) - 1) / alignof(T)) * alignof(T);
+
+				std::byte * mem = reinterpret_cast<std::byte *>(Allocate(nodeOffset + sizeof(T) * count, alignment));
+
+				nodeOut = new (mem) DtorNode{ nullptr, &destroyObjects<T>, mem + nodeOffset, count };
+				return reinterpret_cast<T *>(mem + nodeOffset);
 			}
+		}
+
+		void registerDestructor(DtorNode * node)
+		{
+			if (!node)
+				return;
 
-			return &nuBlock[0];
+			std::scoped_lock sLock(Mutex);
+
+			node->Next = m_dtorHead;
+			m_dtorHead = node;
 		}
 
-		//template <typename T, typename... Types>
-		//T * Get(Types... args)
-		//{
-		//	void * buf = Get(sizeof(T));
-		//	return new buf T(&args...);
-		//}
+	public:
+
+		/// Returns numBytes of memory, with no alignment guarantee.
+		void * Get(size_t numBytes)
+		{
+			recordAlloc(numBytes);
+
+			if (fitsThreadChunk(numBytes, 1))
+				return getConcurrent(numBytes, 1);
+
+			std::scoped_lock sLock(Mutex);
+
+			return getImpl(numBytes);
+		}
+
+		/// Returns numBytes of memory aligned to alignment, which must be a power of two.
+		void * Allocate(size_t numBytes, size_t alignment = alignof(std::max_align_t))
+		{
+			recordAlloc(numBytes);
+
+			if (fitsThreadChunk(numBytes, alignment))
+				return getConcurrent(numBytes, alignment);
+
+			std::scoped_lock sLock(Mutex);
+
+			return getAlignedImpl(numBytes, alignment);
+		}
+
+		/// Constructs a T in the pool. If T is not trivially destructible, its destructor is run by Reset().
+		/// Constructors may allocate from the pool themselves, destructors must not.
+		template <typename T, typename... Args>
+		T * Make(Args &&... args)
+		{
+			DtorNode * node = nullptr;
+			T *        ret  = allocateTracked<T>(1, node);
+
+			new (ret) T(std::forward<Args>(args)...);
+
+			registerDestructor(node);
+			return ret;
+		}
+
+		/// Default-constructs count T's in the pool. If T is not trivially destructible, their destructors are run by Reset().
+		template <typename T>
+		std::span<T> MakeArray(size_t count)
+		{
+			DtorNode * node = nullptr;
+			T *        ret  = allocateTracked<T>(count, node);
+
+			size_t constructed = 0;
+			try
+			{
+				for (; constructed < count; ++constructed)
+					new (ret + constructed) T;
+			}
+			catch (...)
+			{
+				destroyObjects<T>(ret, constructed);
+				throw;
+			}
+
+			registerDestructor(node);
+			return std::span<T>(ret, count);
+		}
 
 		std::span<std::byte> GetCopy(std::span<std::byte> blob)
 		{
@@ -327,27 +745,79 @@ namespace HANDY_NS {
 			return std::span<std::byte>(ret, blob.size());
 		}
 
+		/// Runs the destructors of everything built with Make/MakeArray, then invalidates everything handed out 
+		/// by the pool. Blocks are retained for reuse, see MaxRetainedBlocks.
 		void Reset()
 		{
+			DtorNode * dtors = nullptr;
+
+			Locked(Mutex)
+				std::swap(dtors, m_dtorHead);
+
+			/// Not under the lock, so destructors may still read through other pool objects.
+			for (; dtors != nullptr; dtors = dtors->Next)
+				dtors->Destroy(dtors->Objects, dtors->Count);
+
 			std::scoped_lock sLock(Mutex);
 
-			for (std::vector<std::byte> * item : Blocks)
-				delete item;
+			resetImpl();
+		}
 
-			Blocks.clear();
-			BlockIndex = 0;
-			ByteIndex  = 0;
+		/// Returns the physical memory of all retained (unused) blocks to the OS. The blocks stay mapped, and
+		/// will be faulted back in when they are reused. Their contents are undefined after Trim() (zeroed on
+		/// Linux, but MEM_RESET on Windows may hand back the old data or anything else).
+		void Trim()
+		{
+			std::scoped_lock sLock(Mutex);
 
-			Inited = false;
+			for (Block const & block : SpareBlocks)
+				detail::PageDiscard(block.Data, block.Size);
 		}
+
+		/// BytesInUse counts requested bytes (not alignment padding) since the last Reset(). WastedTailBytes counts
+		/// the unused ends of oversized blocks, of blocks that were moved on from, and of abandoned thread chunks.
+		AllocatorStats Stats()
+		{
+			AllocatorStats ret;
+
+			#if defined HANDY_MEMORY_STATS
+				std::scoped_lock sLock(Mutex);
+
+				for (Block const & block : Blocks)
+					ret.BytesReserved += block.Size;
+
+				for (Block const & block : SpareBlocks)
+					ret.BytesReserved += block.Size;
+
+				ret.NumBlocks       = Blocks.size() + SpareBlocks.size();
+				ret.BytesInUse      = m_stats.BytesInUse     .load(std::memory_order_relaxed);
+				ret.HighWaterBytes  = m_stats.HighWaterBytes .load(std::memory_order_relaxed);
+				ret.WastedTailBytes = m_stats.WastedTailBytes.load(std::memory_order_relaxed);
+
+				for (size_t i = 0; i < ret.SizeHistogram.size(); i++)
+					ret.SizeHistogram[i] = m_stats.SizeHistogram[i].load(std::memory_order_relaxed);
+			#endif
+
+			return ret;
+		}
+
+		/// Unmaps all retained (unused) blocks.
+		void ReleaseSpares()
+		{
+			std::scoped_lock sLock(Mutex);
+
+			for (Block const & block : SpareBlocks)
+				detail::PageFree(block.Data, block.Size);
+
+			SpareBlocks.clear();
+		}
+
 	private:
-		void adoptImpl(std::vector<std::byte> & block)
+		void adoptImpl(Block const & block)
 		{
-			Blocks.emplace_back() = new std::vector<std::byte>();
-			std::swap(*Blocks.back(), block);
+			/// Keep the current block at BlockIndex, adopted blocks are full.
+			Blocks.insert(Blocks.begin() + BlockIndex, block);
 			++BlockIndex;
-
-			std::swap(Blocks[BlockIndex], Blocks[BlockIndex -1]);
 		}
 
 	public:
@@ -357,7 +827,10 @@ namespace HANDY_NS {
 
 			tryInit();
 
-			adoptImpl(block);
+			auto * adopted = new std::vector<std::byte>();
+			std::swap(*adopted, block);
+
+			adoptImpl(Block{ adopted->data(), adopted->size(), adopted });
 		}
 
 		void Adopt(MemoryPool & otherPool)
@@ -366,15 +839,35 @@ namespace HANDY_NS {
 
 			tryInit();
 
-			for (auto blockP : otherPool.Blocks)
-				adoptImpl(*blockP);
+			for (Block const & block : otherPool.Blocks)
+				adoptImpl(block);
+
+			/// The other pool's objects now live in our blocks, so we destruct them too. They count as made at the
+			/// moment of the Adopt: destructed after anything Made here later, but before what was already here.
+			if (otherPool.m_dtorHead)
+			{
+				DtorNode * tail = otherPool.m_dtorHead;
+				while (tail->Next)
+					tail = tail->Next;
+
+				tail->Next = m_dtorHead;
+				m_dtorHead = otherPool.m_dtorHead;
+				otherPool.m_dtorHead = nullptr;
+			}
+
+			#if defined HANDY_MEMORY_STATS
+				recordWaste(otherPool.m_stats.WastedTailBytes.load(std::memory_order_relaxed));
+				m_stats.BytesInUse.fetch_add(otherPool.m_stats.BytesInUse.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			#endif
 
-			otherPool.Reset();
+			otherPool.Blocks.clear();
+			otherPool.resetImpl();
 		}
 
 		~MemoryPool()
 		{
 			Reset();
+			ReleaseSpares();
 		}
 		
 
@@ -382,13 +875,33 @@ namespace HANDY_NS {
 		{
 			std::scoped_lock sLock(Mutex, rhs.Mutex);
 
-			std::swap(Blocks,     rhs.Blocks);
-			std::swap(BlockIndex, rhs.BlockIndex);
-			std::swap(ByteIndex,  rhs.ByteIndex);
-			std::swap(Inited,     rhs.Inited);
+			std::swap(Blocks,      rhs.Blocks);
+			std::swap(SpareBlocks, rhs.SpareBlocks);
+			std::swap(BlockIndex,  rhs.BlockIndex);
+			std::swap(ByteIndex,   rhs.ByteIndex);
+			std::swap(Inited,      rhs.Inited);
+			std::swap(m_dtorHead,  rhs.m_dtorHead);
 			std::swap(TypicalBlockSizeBytes, rhs.TypicalBlockSizeBytes);
-		}
+			std::swap(MaxRetainedBlocks,     rhs.MaxRetainedBlocks);
+			std::swap(UseHugePages,          rhs.UseHugePages);
+			std::swap(ThreadChunkBytes,      rhs.ThreadChunkBytes);
+
+			/// Thread chunks follow the blocks they were carved from.
+			uint64_t const id = m_id.load(std::memory_order_relaxed);
+			m_id.store(rhs.m_id.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			rhs.m_id.store(id, std::memory_order_relaxed);
+
+			#if defined HANDY_MEMORY_STATS
+				auto swapStat = [](std::atomic<size_t> & a, std::atomic<size_t> & b) { b.store(a.exchange(b.load(std::memory_order_relaxed), std::memory_order_relaxed), std::memory_order_relaxed); };
 
+				swapStat(m_stats.BytesInUse,      rhs.m_stats.BytesInUse);
+				swapStat(m_stats.HighWaterBytes,  rhs.m_stats.HighWaterBytes);
+				swapStat(m_stats.WastedTailBytes, rhs.m_stats.WastedTailBytes);
+
+				for (size_t i = 0; i < 64; i++)
+					swapStat(m_stats.SizeHistogram[i], rhs.m_stats.SizeHistogram[i]);
+			#endif
+		}
 		/// ---------
 
 		struct span
@@ -427,6 +940,186 @@ namespace HANDY_NS {
 	{
 		return inItem.Span;
 	}
+
+	///-----------------------------------------------
+	/// Stack Allocator
+	/// Linear allocator for scoped temporaries. Mark() remembers the current top, RewindTo(mark) frees everything
+	/// allocated since, in O(1). Marks nest, but must be rewound in LIFO order. Not thread safe, and nothing 
+	/// allocated here is ever destructed, so only trivially destructible types can be made.
+	///
+	/// Memory comes in BlockSizeBytes blocks which are kept until the allocator is destroyed, so after a warm up
+	/// a loop that rewinds every iteration never touches the OS again. Pointers stay valid until rewound past.
+	class StackAllocator final
+	{
+	public:
+		struct Marker
+		{
+			size_t Block  = 0;
+			size_t Offset = 0;
+		};
+
+		/// Rewinds to where it was constructed when it goes out of scope.
+		class Scope final
+		{
+			StackAllocator & m_alloc;
+			Marker           m_mark;
+
+		public:
+			explicit Scope(StackAllocator & alloc) : m_alloc(alloc), m_mark(alloc.Mark()) { }
+			~Scope() { m_alloc.RewindTo(m_mark); }
+
+			COPY_ASSIGN_MOVE_CTOR(Scope, delete, delete, delete)
+		};
+
+	private:
+		struct Block
+		{
+			std::byte * Data = nullptr;
+			size_t      Size = 0;
+		};
+
+		size_t             m_blockSizeBytes;
+		std::vector<Block> m_blocks;
+		size_t             m_block  = 0; /// Index of the block we're allocating from, only valid if m_blocks isn't empty.
+		size_t             m_offset = 0;
+
+		/// Moves to the next block that can hold minBytes, mapping one if needed.
+		void nextBlock(size_t minBytes)
+		{
+			size_t next = m_blocks.empty() ? 0 : m_block + 1;
+
+			if (next == m_blocks.size() || m_blocks[next].Size < minBytes)
+			{
+				size_t mapSize = detail::PageRoundUp(FastMax(minBytes, m_blockSizeBytes), false);
+
+				void * p = detail::PageAlloc(mapSize, false);
+				if (!p)
+					throw std::bad_alloc();
+
+				/// Blocks past the top are unused, so the new block can go before them without moving any live marker.
+				m_blocks.insert(m_blocks.begin() + next, Block{ reinterpret_cast<std::byte *>(p), mapSize });
+			}
+
+			m_block  = next;
+			m_offset = 0;
+		}
+
+	public:
+		explicit StackAllocator(size_t blockSizeBytes = 1'048'576) : m_blockSizeBytes(blockSizeBytes) { }
+
+		~StackAllocator()
+		{
+			for (Block const & block : m_blocks)
+				detail::PageFree(block.Data, block.Size);
+		}
+
+		COPY_ASSIGN_MOVE_CTOR(StackAllocator, delete, delete, delete)
+
+		/// Returns numBytes of memory aligned to alignment, which must be a power of two.
+		void * Allocate(size_t numBytes, size_t alignment = alignof(std::max_align_t))
+		{
+			if (!m_blocks.empty())
+			{
+				uintptr_t const base    = reinterpret_cast<uintptr_t>(m_blocks[m_block].Data);
+				uintptr_t const aligned = (base + m_offset + alignment - 1) & ~uintptr_t(alignment - 1);
+
+				if (aligned + numBytes <= base + m_blocks[m_block].Size)
+				{
+					m_offset = aligned + numBytes - base;
+					return reinterpret_cast<void *>(aligned);
+				}
+			}
+
+			/// Blocks are page aligned, so we only need slop for alignments larger than a page.
+			size_t const slop = alignment > detail::PageSize() ? alignment - 1 : 0;
+			nextBlock(numBytes + slop);
+
+			uintptr_t const base    = reinterpret_cast<uintptr_t>(m_blocks[m_block].Data);
+			uintptr_t const aligned = (base + alignment - 1) & ~uintptr_t(alignment - 1);
+
+			m_offset = aligned + numBytes - base;
+			return reinterpret_cast<void *>(aligned);
+		}
+
+		template <typename T, typename... Args>
+		T * Make(Args &&... args)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "StackAllocator never runs destructors.");
+
+			return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		}
+
+		/// Default-constructs count T's.
+		template <typename T>
+		std::span<T> MakeArray(size_t count)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "StackAllocator never runs destructors.");
+
+			T * ret = reinterpret_cast<T *>(Allocate(sizeof(T) * count, alignof(T)));
+
+			for (size_t i = 0; i < count; i++)
+				new (ret + i) T;
+
+			return std::span<T>(ret, count);
+		}
+
+		Marker Mark() const { return Marker{ m_block, m_offset }; }
+
+		/// Frees everything allocated since mark was taken.
+		void RewindTo(Marker const & mark)
+		{
+			m_block  = mark.Block;
+			m_offset = mark.Offset;
+		}
+
+		/// Frees everything. Blocks are kept for reuse.
+		void Reset() { RewindTo(Marker{}); }
+
+		/// Bytes currently allocated, including alignment padding and the unused tails of skipped blocks.
+		size_t BytesUsed() const
+		{
+			size_t ret = m_offset;
+			for (size_t i = 0; i < m_block && i < m_blocks.size(); i++)
+				ret += m_blocks[i].Size;
+			return ret;
+		}
+	};
+	///-----------------------------------------------
+
+	///-----------------------------------------------
+	/// Frame Allocator
+	/// Double-buffered StackAllocator for per-tick data. Everything allocated during one frame stays valid through
+	/// the next frame (as Previous()), and is freed wholesale by the NextFrame() call after that.
+	class FrameAllocator final
+	{
+		StackAllocator m_stacks[2];
+		size_t         m_current = 0;
+
+	public:
+		explicit FrameAllocator(size_t blockSizeBytes = 1'048'576) : m_stacks{ StackAllocator(blockSizeBytes), StackAllocator(blockSizeBytes) } { }
+
+		COPY_ASSIGN_MOVE_CTOR(FrameAllocator, delete, delete, delete)
+
+		StackAllocator       & Current()        { return m_stacks[m_current]; }
+		StackAllocator       & Previous()       { return m_stacks[m_current ^ 1]; }
+		StackAllocator const & Previous() const { return m_stacks[m_current ^ 1]; }
+
+		/// Call once per tick. Frees everything from two frames ago, and makes the current frame the previous one.
+		void NextFrame()
+		{
+			m_current ^= 1;
+			m_stacks[m_current].Reset();
+		}
+
+		void * Allocate(size_t numBytes, size_t alignment = alignof(std::max_align_t)) { return Current().Allocate(numBytes, alignment); }
+
+		template <typename T, typename... Args>
+		T * Make(Args &&... args) { return Current().Make<T>(std::forward<Args>(args)...); }
+
+		template <typename T>
+		std::span<T> MakeArray(size_t count) { return Current().MakeArray<T>(count); }
+	};
+	///-----------------------------------------------
 	#endif
 
 
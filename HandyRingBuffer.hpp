@@ -0,0 +1,361 @@
+
+/// ========================================================================
+/// UNLICENSE
+///
+/// This is free and unencumbered software released into the public domain.
+/// Anyone is free to copy, modify, publish, use, compile, sell, or
+/// distribute this software, either in source code form or as a compiled
+/// binary, for any purpose, commercial or non-commercial, and by any
+/// means.
+///
+/// In jurisdictions that recognize copyright laws, the author or authors
+/// of this software dedicate any and all copyright interest in the
+/// software to the public domain. We make this dedication for the benefit
+/// of the public at large and to the detriment of our heirs and
+/// successors. We intend this dedication to be an overt act of
+/// relinquishment in perpetuity of all present and future rights to this
+/// software under copyright law.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+/// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+/// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+/// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+/// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/// OTHER DEALINGS IN THE SOFTWARE.
+///
+/// For more information, please refer to <http://unlicense.org/>
+/// ========================================================================
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "HandyBase.hpp"
+#include "HandyCompat.hpp"
+
+namespace HANDY_NS {
+
+	/// What a RingBuffer does when pushing into a full buffer.
+	enum class RingGrowth
+	{
+		Grow,      /// Double the capacity. The only policy that ever allocates after reserve().
+		Overwrite, /// Drop the element at the other end, e.g. push_back drops front(). For sliding windows.
+		Reject,    /// Leave the buffer alone, and return false from the push.
+	};
+
+	///-----------------------------------------------
+	/// Ring Buffer
+	/// Contiguous, power-of-two sized ring buffer with a deque-like interface. Element i lives at
+	/// (head + i) & mask, so random access is an add and an AND, and the contents are at most two
+	/// contiguous runs (see spans()). Unlike htd::deque there is no map of blocks, and nothing is
+	/// allocated once the capacity is reserved.
+	template <typename T, RingGrowth Growth = RingGrowth::Grow>
+	class RingBuffer
+	{
+		T *    m_data     = nullptr;
+		size_t m_capacity = 0; /// Zero or a power of two.
+		size_t m_head     = 0;
+		size_t m_size     = 0;
+
+		size_t mask() const { return m_capacity - 1; }
+
+		T * slot(size_t i) const { return m_data + ((m_head + i) & mask()); }
+
+		/// Strong guarantee: if an element's copy throws, the buffer is left as it was. (Moves are only used
+		/// when they can't throw.)
+		void reallocate(size_t newCapacity)
+		{
+			T *    nuData = std::allocator<T>().allocate(newCapacity);
+			size_t i      = 0;
+
+			try
+			{
+				for (; i < m_size; i++)
+					new (nuData + i) T(std::move_if_noexcept(*slot(i)));
+			}
+			catch (...)
+			{
+				while (i > 0)
+					nuData[--i].~T();
+
+				std::allocator<T>().deallocate(nuData, newCapacity);
+				throw;
+			}
+
+			if constexpr (!std::is_trivially_destructible_v<T>)
+			{
+				for (i = 0; i < m_size; i++)
+					slot(i)->~T();
+			}
+
+			if (m_data)
+				std::allocator<T>().deallocate(m_data, m_capacity);
+
+			m_data     = nuData;
+			m_capacity = newCapacity;
+			m_head     = 0;
+		}
+
+		/// Makes room for one more element in a full buffer. Returns false if the push must not happen.
+		bool makeRoom(bool atBack)
+		{
+			if constexpr (Growth == RingGrowth::Grow)
+			{
+				reallocate(m_capacity ? m_capacity * 2 : 16);
+				return true;
+			}
+			else if constexpr (Growth == RingGrowth::Overwrite)
+			{
+				if (m_capacity == 0)
+					return false;
+
+				if (atBack)
+					pop_front();
+				else
+					pop_back();
+
+				return true;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+	public:
+		using value_type      = T;
+		using size_type       = size_t;
+		using difference_type = ptrdiff_t;
+		using reference       = T &;
+		using const_reference = T const &;
+
+		template <typename TRing, typename TVal>
+		class iterator_base
+		{
+			TRing * m_ring  = nullptr;
+			size_t  m_index = 0;
+
+		public:
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type        = std::remove_const_t<TVal>;
+			using difference_type   = ptrdiff_t;
+			using pointer           = TVal *;
+			using reference         = TVal &;
+
+			iterator_base() = default;
+			iterator_base(TRing * ring, size_t index) : m_ring(ring), m_index(index) { }
+
+			reference operator*()  const { return (*m_ring)[m_index]; }
+			pointer   operator->() const { return &(*m_ring)[m_index]; }
+			reference operator[](difference_type n) const { return (*m_ring)[m_index + n]; }
+
+			iterator_base & operator++()    { ++m_index; return *this; }
+			iterator_base & operator--()    { --m_index; return *this; }
+			iterator_base   operator++(int) { iterator_base t = *this; ++m_index; return t; }
+			iterator_base   operator--(int) { iterator_base t = *this; --m_index; return t; }
+
+			iterator_base & operator+=(difference_type n) { m_index += n; return *this; }
+			iterator_base & operator-=(difference_type n) { m_index -= n; return *this; }
+
+			iterator_base operator+(difference_type n) const { return iterator_base(m_ring, m_index + n); }
+			iterator_base operator-(difference_type n) const { return iterator_base(m_ring, m_index - n); }
+
+			friend iterator_base operator+(difference_type n, iterator_base const & it) { return it + n; }
+
+			difference_type operator-(iterator_base const & rhs) const { return difference_type(m_index) - difference_type(rhs.m_index); }
+
+			bool operator==(iterator_base const & rhs) const { return m_index == rhs.m_index; }
+			bool operator!=(iterator_base const & rhs) const { return m_index != rhs.m_index; }
+			bool operator< (iterator_base const & rhs) const { return m_index <  rhs.m_index; }
+			bool operator> (iterator_base const & rhs) const { return m_index >  rhs.m_index; }
+			bool operator<=(iterator_base const & rhs) const { return m_index <= rhs.m_index; }
+			bool operator>=(iterator_base const & rhs) const { return m_index >= rhs.m_index; }
+		};
+
+		using iterator       = iterator_base<RingBuffer,       T>;
+		using const_iterator = iterator_base<RingBuffer const, T const>;
+
+		RingBuffer() = default;
+
+		/// Capacity is rounded up to a power of two.
+		explicit RingBuffer(size_t capacity) { reserve(capacity); }
+
+		RingBuffer(RingBuffer const & rhs)
+		{
+			reserve(rhs.m_capacity);
+			for (T const & v : rhs)
+				push_back(v);
+		}
+
+		RingBuffer(RingBuffer && rhs) noexcept { swap(rhs); }
+
+		RingBuffer & operator=(RingBuffer rhs) noexcept
+		{
+			swap(rhs);
+			return *this;
+		}
+
+		~RingBuffer()
+		{
+			clear();
+
+			if (m_data)
+				std::allocator<T>().deallocate(m_data, m_capacity);
+		}
+
+		void swap(RingBuffer & rhs) noexcept
+		{
+			std::swap(m_data,     rhs.m_data);
+			std::swap(m_capacity, rhs.m_capacity);
+			std::swap(m_head,     rhs.m_head);
+			std::swap(m_size,     rhs.m_size);
+		}
+
+		/// Ensures room for n elements, rounding the capacity up to a power of two. Never shrinks.
+		void reserve(size_t n)
+		{
+			if (n > m_capacity)
+				reallocate(size_t(NextPowerOfTwo(uint64_t(n))));
+		}
+
+		/// args may refer to an element of the buffer (e.g. push_back(front())), which making room moves
+		/// or destroys, so when full the new element is built before anything else is touched.
+		template <typename... Args>
+		bool emplace_back(Args &&... args)
+		{
+			if (m_size < m_capacity)
+				new (slot(m_size)) T(std::forward<Args>(args)...);
+			else
+			{
+				if constexpr (Growth == RingGrowth::Reject)
+					return false;
+
+				T tmp(std::forward<Args>(args)...);
+
+				if (!makeRoom(true))
+					return false;
+
+				new (slot(m_size)) T(std::move(tmp));
+			}
+
+			++m_size;
+			return true;
+		}
+
+		template <typename... Args>
+		bool emplace_front(Args &&... args)
+		{
+			if (m_size < m_capacity)
+				new (m_data + ((m_head - 1) & mask())) T(std::forward<Args>(args)...);
+			else
+			{
+				if constexpr (Growth == RingGrowth::Reject)
+					return false;
+
+				T tmp(std::forward<Args>(args)...);
+
+				if (!makeRoom(false))
+					return false;
+
+				new (m_data + ((m_head - 1) & mask())) T(std::move(tmp));
+			}
+
+			m_head = (m_head - 1) & mask();
+			++m_size;
+			return true;
+		}
+
+		/// Returns false if the element was rejected, which only happens with RingGrowth::Reject (or a
+		/// zero capacity RingGrowth::Overwrite buffer).
+		bool push_back (T const & v) { return emplace_back (v); }
+		bool push_back (T &&      v) { return emplace_back (std::move(v)); }
+		bool push_front(T const & v) { return emplace_front(v); }
+		bool push_front(T &&      v) { return emplace_front(std::move(v)); }
+
+		void pop_front()
+		{
+			assert(m_size > 0);
+
+			m_data[m_head].~T();
+			m_head = (m_head + 1) & mask();
+			--m_size;
+		}
+
+		void pop_back()
+		{
+			assert(m_size > 0);
+
+			slot(m_size - 1)->~T();
+			--m_size;
+		}
+
+		void clear()
+		{
+			if constexpr (!std::is_trivially_destructible_v<T>)
+			{
+				for (size_t i = 0; i < m_size; i++)
+					slot(i)->~T();
+			}
+
+			m_head = 0;
+			m_size = 0;
+		}
+
+		T       & operator[](size_t i)       { assert(i < m_size); return *slot(i); }
+		T const & operator[](size_t i) const { assert(i < m_size); return *slot(i); }
+
+		T & at(size_t i)
+		{
+			if (i >= m_size)
+				throw std::out_of_range("RingBuffer::at");
+			return *slot(i);
+		}
+
+		T const & at(size_t i) const
+		{
+			if (i >= m_size)
+				throw std::out_of_range("RingBuffer::at");
+			return *slot(i);
+		}
+
+		T       & front()       { return (*this)[0]; }
+		T const & front() const { return (*this)[0]; }
+		T       & back()        { return (*this)[m_size - 1]; }
+		T const & back()  const { return (*this)[m_size - 1]; }
+
+		size_t size()     const { return m_size; }
+		size_t capacity() const { return m_capacity; }
+		bool   empty()    const { return m_size == 0; }
+		bool   full()     const { return m_size == m_capacity; }
+
+		/// The contents as two contiguous runs, the second of which is empty unless the contents wrap.
+		/// Walking these is faster than walking the iterators, since there is no masking per element.
+		std::pair<std::span<T>, std::span<T>> spans()
+		{
+			size_t const first = m_size < m_capacity - m_head ? m_size : m_capacity - m_head;
+			return { std::span<T>(m_data + m_head, first), std::span<T>(m_data, m_size - first) };
+		}
+
+		std::pair<std::span<T const>, std::span<T const>> spans() const
+		{
+			size_t const first = m_size < m_capacity - m_head ? m_size : m_capacity - m_head;
+			return { std::span<T const>(m_data + m_head, first), std::span<T const>(m_data, m_size - first) };
+		}
+
+		iterator       begin()        { return iterator      (this, 0);      }
+		iterator       end()          { return iterator      (this, m_size); }
+		const_iterator begin()  const { return const_iterator(this, 0);      }
+		const_iterator end()    const { return const_iterator(this, m_size); }
+		const_iterator cbegin() const { return begin(); }
+		const_iterator cend()   const { return end();   }
+	};
+	///-----------------------------------------------
+
+} // HANDY_NS
@@ -0,0 +1,263 @@
+
+/// ========================================================================
+/// UNLICENSE
+///
+/// This is free and unencumbered software released into the public domain.
+/// Anyone is free to copy, modify, publish, use, compile, sell, or
+/// distribute this software, either in source code form or as a compiled
+/// binary, for any purpose, commercial or non-commercial, and by any
+/// means.
+///
+/// In jurisdictions that recognize copyright laws, the author or authors
+/// of this software dedicate any and all copyright interest in the
+/// software to the public domain. We make this dedication for the benefit
+/// of the public at large and to the detriment of our heirs and
+/// successors. We intend this dedication to be an overt act of
+/// relinquishment in perpetuity of all present and future rights to this
+/// software under copyright law.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+/// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+/// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+/// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+/// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/// OTHER DEALINGS IN THE SOFTWARE.
+///
+/// For more information, please refer to <http://unlicense.org/>
+/// ========================================================================
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "HandyBase.hpp"
+#include "HandyCompat.hpp"
+
+namespace HANDY_NS {
+
+	///-----------------------------------------------
+	/// Slot Map Handle
+	/// Index in the low 32 bits, generation in the high 32 bits. Generations start at 1, so a
+	/// default constructed (zero) handle is never valid.
+	struct SlotHandle
+	{
+		uint64_t Value = 0;
+
+		constexpr SlotHandle() = default;
+		constexpr explicit SlotHandle(uint64_t value) : Value(value) { }
+		constexpr SlotHandle(uint32_t index, uint32_t generation) : Value(uint64_t(generation) << 32 | index) { }
+
+		constexpr uint32_t index()      const { return uint32_t(Value); }
+		constexpr uint32_t generation() const { return uint32_t(Value >> 32); }
+
+		constexpr bool is_null() const { return Value == 0; }
+
+		constexpr bool operator==(SlotHandle const & rhs) const { return Value == rhs.Value; }
+		constexpr bool operator!=(SlotHandle const & rhs) const { return Value != rhs.Value; }
+
+		template <class SerialOp> void serial(SerialOp & ser)
+		{
+			ser(Value);
+		}
+	};
+
+	///-----------------------------------------------
+	/// Slot Map
+	/// Owns a set of T's, addressed by stable SlotHandles. Values are kept densely packed in one vector,
+	/// so iterating them is a linear walk. Insert and erase are O(1): erase moves the last value into the
+	/// hole, so it reorders values and invalidates pointers/iterators, but never handles.
+	///
+	/// Erasing (or clearing) bumps the generation of the slot, so any handle to the old value goes stale,
+	/// and get() returns nullptr for it instead of an unrelated value. A slot's generation wraps after
+	/// 2^32 reuses, skipping zero.
+	template <typename T>
+	class SlotMap
+	{
+		static constexpr uint32_t EndOfFreeList = std::numeric_limits<uint32_t>::max();
+
+		struct Slot
+		{
+			uint32_t DenseOrNextFree; /// Index into m_values if live, otherwise the next free slot.
+			uint32_t Generation;
+		};
+
+		std::vector<T>        m_values;
+		std::vector<uint32_t> m_valueSlots;  /// Parallel to m_values, the slot that points at each value.
+		std::vector<Slot>     m_slots;
+		uint32_t              m_freeHead = EndOfFreeList;
+
+		uint32_t claimSlot(uint32_t dense)
+		{
+			if (m_freeHead != EndOfFreeList)
+			{
+				uint32_t const slot = m_freeHead;
+				m_freeHead = m_slots[slot].DenseOrNextFree;
+				m_slots[slot].DenseOrNextFree = dense;
+				return slot;
+			}
+
+			assert(m_slots.size() < EndOfFreeList);
+
+			m_slots.push_back(Slot{ dense, 1 });
+			return uint32_t(m_slots.size() - 1);
+		}
+
+		void releaseSlot(uint32_t slot)
+		{
+			if (++m_slots[slot].Generation == 0)
+				m_slots[slot].Generation = 1;
+
+			m_slots[slot].DenseOrNextFree = m_freeHead;
+			m_freeHead = slot;
+		}
+
+		Slot const * findSlot(SlotHandle h) const
+		{
+			if (h.index() >= m_slots.size())
+				return nullptr;
+
+			Slot const & slot = m_slots[h.index()];
+			return slot.Generation == h.generation() ? &slot : nullptr;
+		}
+
+	public:
+		using value_type     = T;
+		using iterator       = typename std::vector<T>::iterator;
+		using const_iterator = typename std::vector<T>::const_iterator;
+
+		template <typename... Args>
+		SlotHandle emplace(Args &&... args)
+		{
+			uint32_t const dense = uint32_t(m_values.size());
+
+			m_values.emplace_back(std::forward<Args>(args)...);
+
+			uint32_t slot;
+			try
+			{
+				slot = claimSlot(dense);
+				m_valueSlots.push_back(slot);
+			}
+			catch (...)
+			{
+				m_values.pop_back();
+				throw;
+			}
+
+			return SlotHandle(slot, m_slots[slot].Generation);
+		}
+
+		SlotHandle insert(T const & value) { return emplace(value); }
+		SlotHandle insert(T &&      value) { return emplace(std::move(value)); }
+
+		/// Returns false if the handle was already stale.
+		bool erase(SlotHandle h)
+		{
+			Slot const * slot = findSlot(h);
+			if (!slot)
+				return false;
+
+			uint32_t const dense = slot->DenseOrNextFree;
+			uint32_t const last  = uint32_t(m_values.size() - 1);
+
+			if (dense != last)
+			{
+				m_values    [dense] = std::move(m_values[last]);
+				m_valueSlots[dense] = m_valueSlots[last];
+				m_slots[m_valueSlots[dense]].DenseOrNextFree = dense;
+			}
+
+			m_values.pop_back();
+			m_valueSlots.pop_back();
+
+			releaseSlot(h.index());
+			return true;
+		}
+
+		/// Returns nullptr if the handle is stale.
+		T * get(SlotHandle h)
+		{
+			Slot const * slot = findSlot(h);
+			return slot ? &m_values[slot->DenseOrNextFree] : nullptr;
+		}
+
+		T const * get(SlotHandle h) const
+		{
+			Slot const * slot = findSlot(h);
+			return slot ? &m_values[slot->DenseOrNextFree] : nullptr;
+		}
+
+		bool contains(SlotHandle h) const { return findSlot(h) != nullptr; }
+
+		/// Unchecked, other than by assert.
+		T & operator[](SlotHandle h)
+		{
+			assert(contains(h));
+			return m_values[m_slots[h.index()].DenseOrNextFree];
+		}
+
+		T const & operator[](SlotHandle h) const
+		{
+			assert(contains(h));
+			return m_values[m_slots[h.index()].DenseOrNextFree];
+		}
+
+		/// The handle of the value at position denseIndex, for use while iterating.
+		SlotHandle handle_at(size_t denseIndex) const
+		{
+			uint32_t const slot = m_valueSlots[denseIndex];
+			return SlotHandle(slot, m_slots[slot].Generation);
+		}
+
+		/// Invalidates every handle. Slots are kept for reuse.
+		void clear()
+		{
+			for (uint32_t slot : m_valueSlots)
+				releaseSlot(slot);
+
+			m_values.clear();
+			m_valueSlots.clear();
+		}
+
+		void reserve(size_t n)
+		{
+			m_values.reserve(n);
+			m_valueSlots.reserve(n);
+			m_slots.reserve(n);
+		}
+
+		size_t size()  const { return m_values.size(); }
+		bool   empty() const { return m_values.empty(); }
+
+		T       * data()       { return m_values.data(); }
+		T const * data() const { return m_values.data(); }
+
+		std::span<T>       values()       { return std::span<T>      (m_values.data(), m_values.size()); }
+		std::span<T const> values() const { return std::span<T const>(m_values.data(), m_values.size()); }
+
+		iterator       begin()       { return m_values.begin(); }
+		iterator       end()         { return m_values.end();   }
+		const_iterator begin() const { return m_values.begin(); }
+		const_iterator end()   const { return m_values.end();   }
+	};
+	///-----------------------------------------------
+
+} // HANDY_NS
+
+namespace std
+{
+	template<>
+	struct hash<HANDY_NS::SlotHandle>
+	{
+		size_t operator()(HANDY_NS::SlotHandle const & h) const noexcept
+		{
+			return std::hash<uint64_t>()(h.Value);
+		}
+	};
+}
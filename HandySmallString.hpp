@@ -0,0 +1,418 @@
+
+/// ========================================================================
+/// UNLICENSE
+///
+/// This is free and unencumbered software released into the public domain.
+/// Anyone is free to copy, modify, publish, use, compile, sell, or
+/// distribute this software, either in source code form or as a compiled
+/// binary, for any purpose, commercial or non-commercial, and by any
+/// means.
+///
+/// In jurisdictions that recognize copyright laws, the author or authors
+/// of this software dedicate any and all copyright interest in the
+/// software to the public domain. We make this dedication for the benefit
+/// of the public at large and to the detriment of our heirs and
+/// successors. We intend this dedication to be an overt act of
+/// relinquishment in perpetuity of all present and future rights to this
+/// software under copyright law.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+/// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+/// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+/// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+/// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/// OTHER DEALINGS IN THE SOFTWARE.
+///
+/// For more information, please refer to <http://unlicense.org/>
+/// ========================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "HandyBase.hpp"
+#include "HandyFlatHash.hpp"
+#include "HandyMemory.hpp"
+#include "HandyString.hpp"
+
+namespace HANDY_NS {
+
+	///-----------------------------------------------
+	/// Small String
+	/// std::string-like string with room for N chars inline, the same idea as small_vector. libstdc++
+	/// only keeps 15 chars inline, so typical identifiers (16-48 chars) each cost a heap allocation.
+	/// A small_string<47> holds those with no allocation at all.
+	///
+	/// Longer strings spill to the heap, or, if the string was given a MemoryPool, to the pool. Pool
+	/// memory is never handed back: a string that grows again just takes a new piece, and the pool
+	/// must outlive the string. Copies share the source's pool.
+	///
+	/// Converts implicitly to std::string_view, so anything that takes a view (ExplodeView(), SafeConvert(),
+	/// ...) takes a small_string. Converting to std::string is explicit, since it allocates. Trim(),
+	/// Explode() and TokenizeWSep() have overloads below that return small_strings.
+	template <size_t N>
+	class small_string
+	{
+		static_assert(N > 0, "small_string needs an inline buffer.");
+
+		char *       m_data     = m_inline;
+		size_t       m_size     = 0;
+		size_t       m_capacity = N; /// Not counting the terminator.
+		MemoryPool * m_pool     = nullptr;
+		char         m_inline[N + 1] = {};
+
+		template <size_t M> friend class small_string;
+
+		char * allocate(size_t capacity)
+		{
+			return m_pool ? static_cast<char *>(m_pool->Get(capacity + 1)) : new char[capacity + 1];
+		}
+
+		void release()
+		{
+			if (!is_inline() && !m_pool)
+				delete[] m_data;
+		}
+
+		void resetInline()
+		{
+			m_data      = m_inline;
+			m_size      = 0;
+			m_capacity  = N;
+			m_inline[0] = '\0';
+		}
+
+		void grow(size_t required)
+		{
+			size_t const newCapacity = std::max(required, m_capacity * 2);
+			char *       fresh       = allocate(newCapacity);
+
+			std::memcpy(fresh, m_data, m_size + 1);
+			release();
+
+			m_data     = fresh;
+			m_capacity = newCapacity;
+		}
+
+	public:
+		using value_type      = char;
+		using size_type       = size_t;
+		using iterator        = char *;
+		using const_iterator  = char const *;
+		using traits_type     = std::char_traits<char>;
+
+		static constexpr size_t npos          = std::string_view::npos;
+		static constexpr size_t InlineCapacity = N;
+
+		small_string() = default;
+		explicit small_string(MemoryPool & pool) : m_pool(&pool) { }
+
+		small_string(char const * str)                                      { assign(std::string_view(str)); }
+		explicit small_string(std::string_view str)                         { assign(str); }
+		explicit small_string(std::string const & str)                      { assign(std::string_view(str)); }
+		small_string(std::string_view str, MemoryPool & pool) : m_pool(&pool) { assign(str); }
+		small_string(size_t count, char ch)                                 { resize(count, ch); }
+
+		small_string(small_string const & rhs) : m_pool(rhs.m_pool) { assign(std::string_view(rhs)); }
+
+		template <size_t M>
+		explicit small_string(small_string<M> const & rhs) : m_pool(rhs.m_pool) { assign(std::string_view(rhs)); }
+
+		small_string(small_string && rhs) noexcept
+		{
+			if (rhs.is_inline())
+			{
+				m_pool = rhs.m_pool;
+				std::memcpy(m_inline, rhs.m_inline, rhs.m_size + 1);
+				m_size = rhs.m_size;
+			}
+			else
+			{
+				m_data     = rhs.m_data;
+				m_size     = rhs.m_size;
+				m_capacity = rhs.m_capacity;
+				m_pool     = rhs.m_pool;
+			}
+
+			rhs.resetInline();
+		}
+
+		~small_string() { release(); }
+
+		small_string & operator=(small_string const & rhs)
+		{
+			if (this != &rhs)
+				assign(std::string_view(rhs));
+			return *this;
+		}
+
+		small_string & operator=(small_string && rhs) noexcept
+		{
+			if (this == &rhs)
+				return *this;
+
+			if (rhs.is_inline())
+			{
+				/// Keep our own buffer (and pool), and just copy.
+				std::memcpy(m_data, rhs.m_data, rhs.m_size + 1);
+				m_size = rhs.m_size;
+			}
+			else
+			{
+				release();
+				m_data     = rhs.m_data;
+				m_size     = rhs.m_size;
+				m_capacity = rhs.m_capacity;
+				m_pool     = rhs.m_pool;
+			}
+
+			rhs.resetInline();
+			return *this;
+		}
+
+		small_string & operator=(std::string_view str)    { return assign(str); }
+		small_string & operator=(char const * str)        { return assign(std::string_view(str)); }
+		small_string & operator=(std::string const & str) { return assign(std::string_view(str)); }
+
+		small_string & assign(std::string_view str)
+		{
+			if (str.size() > m_capacity)
+			{
+				/// Don't let grow() copy our old contents: str may point into them.
+				char * fresh = allocate(str.size());
+				std::memcpy(fresh, str.data(), str.size());
+				release();
+				m_data     = fresh;
+				m_capacity = str.size();
+			}
+			else
+			{
+				std::memmove(m_data, str.data(), str.size());
+			}
+
+			m_size         = str.size();
+			m_data[m_size] = '\0';
+			return *this;
+		}
+
+		operator std::string_view() const { return std::string_view(m_data, m_size); }
+		explicit operator std::string() const { return std::string(m_data, m_size); }
+
+		std::string      str()  const { return std::string(m_data, m_size); }
+		std::string_view view() const { return std::string_view(m_data, m_size); }
+
+		char *       data()        { return m_data; }
+		char const * data()  const { return m_data; }
+		char const * c_str() const { return m_data; }
+
+		size_t size()      const { return m_size; }
+		size_t length()    const { return m_size; }
+		size_t capacity()  const { return m_capacity; }
+		bool   empty()     const { return m_size == 0; }
+		bool   is_inline() const { return m_data == m_inline; }
+
+		MemoryPool * pool() const { return m_pool; }
+
+		iterator       begin()       { return m_data; }
+		iterator       end()         { return m_data + m_size; }
+		const_iterator begin() const { return m_data; }
+		const_iterator end()   const { return m_data + m_size; }
+
+		char &       operator[](size_t i)       { assert(i <= m_size); return m_data[i]; }
+		char const & operator[](size_t i) const { assert(i <= m_size); return m_data[i]; }
+
+		char & at(size_t i)
+		{
+			if (i >= m_size)
+				throw std::out_of_range("small_string index out of range.");
+			return m_data[i];
+		}
+
+		char const & at(size_t i) const { return const_cast<small_string &>(*this).at(i); }
+
+		char &       front()       { assert(m_size); return m_data[0]; }
+		char const & front() const { assert(m_size); return m_data[0]; }
+		char &       back()        { assert(m_size); return m_data[m_size - 1]; }
+		char const & back()  const { assert(m_size); return m_data[m_size - 1]; }
+
+		void reserve(size_t capacity)
+		{
+			if (capacity > m_capacity)
+				grow(capacity);
+		}
+
+		void resize(size_t count, char ch = '\0')
+		{
+			reserve(count);
+			if (count > m_size)
+				std::memset(m_data + m_size, ch, count - m_size);
+			m_size         = count;
+			m_data[m_size] = '\0';
+		}
+
+		void clear()
+		{
+			m_size    = 0;
+			m_data[0] = '\0';
+		}
+
+		void push_back(char ch)
+		{
+			if (m_size == m_capacity)
+				grow(m_size + 1);
+			m_data[m_size++] = ch;
+			m_data[m_size]   = '\0';
+		}
+
+		void pop_back()
+		{
+			assert(m_size);
+			m_data[--m_size] = '\0';
+		}
+
+		small_string & append(std::string_view str)
+		{
+			if (m_size + str.size() > m_capacity)
+			{
+				/// str may point into our buffer, which grow() frees.
+				size_t const offset = size_t(str.data() - m_data);
+				bool   const inside = str.data() >= m_data && str.data() < m_data + m_size;
+
+				grow(m_size + str.size());
+
+				if (inside)
+					str = std::string_view(m_data + offset, str.size());
+			}
+
+			std::memmove(m_data + m_size, str.data(), str.size());
+			m_size        += str.size();
+			m_data[m_size] = '\0';
+			return *this;
+		}
+
+		small_string & append(size_t count, char ch)
+		{
+			resize(m_size + count, ch);
+			return *this;
+		}
+
+		small_string & operator+=(std::string_view str)    { return append(str); }
+		small_string & operator+=(char const * str)        { return append(std::string_view(str)); }
+		small_string & operator+=(std::string const & str) { return append(std::string_view(str)); }
+		small_string & operator+=(char ch)                 { push_back(ch); return *this; }
+
+		/// The substring keeps this string's pool.
+		small_string substr(size_t pos = 0, size_t count = npos) const
+		{
+			if (pos > m_size)
+				throw std::out_of_range("small_string::substr pos out of range.");
+
+			small_string ret;
+			ret.m_pool = m_pool;
+			ret.assign(view().substr(pos, count));
+			return ret;
+		}
+
+		size_t find             (std::string_view str, size_t pos = 0)    const { return view().find(str, pos); }
+		size_t find             (char ch,              size_t pos = 0)    const { return view().find(ch, pos); }
+		size_t rfind            (std::string_view str, size_t pos = npos) const { return view().rfind(str, pos); }
+		size_t rfind            (char ch,              size_t pos = npos) const { return view().rfind(ch, pos); }
+		size_t find_first_of    (std::string_view str, size_t pos = 0)    const { return view().find_first_of(str, pos); }
+		size_t find_first_not_of(std::string_view str, size_t pos = 0)    const { return view().find_first_not_of(str, pos); }
+
+		int compare(std::string_view str) const { return view().compare(str); }
+
+		friend bool operator==(small_string const & lhs, std::string_view rhs) { return lhs.view() == rhs; }
+		friend bool operator!=(small_string const & lhs, std::string_view rhs) { return lhs.view() != rhs; }
+		friend bool operator< (small_string const & lhs, std::string_view rhs) { return lhs.view() <  rhs; }
+		friend bool operator==(std::string_view lhs, small_string const & rhs) { return lhs == rhs.view(); }
+		friend bool operator!=(std::string_view lhs, small_string const & rhs) { return lhs != rhs.view(); }
+		friend bool operator< (std::string_view lhs, small_string const & rhs) { return lhs <  rhs.view(); }
+
+		template <size_t M> bool operator==(small_string<M> const & rhs) const { return view() == rhs.view(); }
+		template <size_t M> bool operator!=(small_string<M> const & rhs) const { return view() != rhs.view(); }
+		template <size_t M> bool operator< (small_string<M> const & rhs) const { return view() <  rhs.view(); }
+	};
+
+	template <size_t N> struct FlatHash<small_string<N>> : detail::FlatStringHash {};
+	template <size_t N> struct FlatEq  <small_string<N>> : std::equal_to<>        {};
+
+	///-----------------------------------------------
+	/// HandyString helpers, for small_string. The results are small_strings of the same size, and share
+	/// the input's pool.
+
+	template <size_t N>
+	small_string<N> TrimLeft(small_string<N> const & str)
+	{
+		std::string_view const v = TrimLeft(str.view());
+		return str.substr(size_t(v.data() - str.data()), v.size());
+	}
+
+	template <size_t N>
+	small_string<N> TrimRight(small_string<N> const & str)
+	{
+		return str.substr(0, TrimRight(str.view()).size());
+	}
+
+	template <size_t N>
+	small_string<N> Trim(small_string<N> const & str)
+	{
+		std::string_view const v = Trim(str.view());
+		return str.substr(size_t(v.data() - str.data()), v.size());
+	}
+
+	template <size_t N>
+	std::vector<small_string<N>> Explode(small_string<N> const & str, char separator)
+	{
+		std::vector<small_string<N>> result;
+		size_t npos, pos = 0;
+
+		do
+		{
+			npos = str.find(separator, pos);
+			result.push_back(str.substr(pos, npos != small_string<N>::npos ? npos - pos : small_string<N>::npos));
+			pos = npos + 1;
+		} while (npos != small_string<N>::npos);
+
+		return result;
+	}
+
+	template <size_t N>
+	std::vector<small_string<N>> TokenizeWSep(small_string<N> const & string, std::string_view delimiters)
+	{
+		std::vector<small_string<N>> tokens;
+		small_string<N>              str = string.substr(0, 0);
+
+		for (size_t i = 0; i < string.size(); i++)
+		{
+			if (delimiters.find(string[i]) != std::string_view::npos)
+			{
+				if (str.size())
+				{
+					tokens.push_back(str);
+					str.clear();
+				}
+				tokens.push_back(string.substr(i, 1));
+			}
+			else str += string[i];
+		}
+		return str.empty() ? tokens : (tokens.push_back(str), tokens);
+	}
+}
+
+namespace std {
+	template <size_t N>
+	struct hash<HANDY_NS::small_string<N>>
+	{
+		size_t operator()(HANDY_NS::small_string<N> const & str) const { return hash<string_view>()(str.view()); }
+	};
+}
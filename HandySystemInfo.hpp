@@ -107,6 +107,15 @@ namespace HANDY_NS {
 		bool AVX512PF; // AVX-512 Pre-Fetch Instructions
 		bool AVX512ER; // AVX-512 Exponential and Reciprocal Instructions
 		bool AVX512CD; // AVX-512 Conflict Detection Instructions
+		bool AVX512DQ; // AVX-512 Doubleword and Quadword Instructions
+		bool AVX512BW; // AVX-512 Byte and Word Instructions
+		bool AVX512VL; // AVX-512 Vector Length Extensions
+		bool AVX512VPOPCNTDQ; // AVX-512 Vector Population Count
+
+		// Whether the OS saves the YMM/ZMM registers on a context switch (XCR0). Without this, the
+		// AVX/AVX-512 flags above say what the CPU has, not what is safe to use.
+		bool OSAVX;
+		bool OSAVX512;
 
 						// AMD-only SSE extensions (Introduced in AMD Barcelona Architecture)
 		bool SSE4a;
@@ -133,6 +142,7 @@ namespace HANDY_NS {
 
 	uint64_t        InstalledMemorySizeBytes(); // Get the size of installed RAM available to the OS, in bytes.
 	CPUCapabilities CPUInfo();                  // Get a structure describing the capabilities/intrinsics of the CPU.
+	CPUCapabilities const & CPUInfoCached();    // CPUInfo(), queried once. For picking SIMD code paths at runtime.
 	std::string     SystemInfoString();         // Get a string with formatted, human-readable text showing info on the running system.
 
 	namespace Paths {
@@ -0,0 +1,393 @@
+
+/// ========================================================================
+/// UNLICENSE
+///
+/// This is free and unencumbered software released into the public domain.
+/// Anyone is free to copy, modify, publish, use, compile, sell, or
+/// distribute this software, either in source code form or as a compiled
+/// binary, for any purpose, commercial or non-commercial, and by any
+/// means.
+///
+/// In jurisdictions that recognize copyright laws, the author or authors
+/// of this software dedicate any and all copyright interest in the
+/// software to the public domain. We make this dedication for the benefit
+/// of the public at large and to the detriment of our heirs and
+/// successors. We intend this dedication to be an overt act of
+/// relinquishment in perpetuity of all present and future rights to this
+/// software under copyright law.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+/// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+/// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+/// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+/// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/// OTHER DEALINGS IN THE SOFTWARE.
+///
+/// For more information, please refer to <http://unlicense.org/>
+/// ========================================================================
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "HandyBase.hpp"
+#include "HandyCompat.hpp"
+#include "HandyHash.hpp"
+#include "HandyMMFile.hpp"
+#include "HandySerDe.hpp"
+#include "HandyThreadUtils.hpp"
+
+namespace HANDY_NS::Hash {
+
+	/// What TreeHash hashes chunks and nodes with.
+	enum class TreeHashAlgorithm : uint8_t
+	{
+		XXH3 = 0, /// 128-bit XXH3. Fast, for fingerprinting and catching corruption, not tampering.
+		SHA3 = 1  /// SHA3-256. Several times slower, but cryptographic.
+	};
+
+	///-----------------------------------------------
+	/// Tree Hash
+	/// Splits the input into fixed size chunks, hashes the chunks in parallel on a ThreadPool, then
+	/// combines the chunk digests pairwise into a Merkle tree. Files are hashed straight from a
+	/// read-only memory mapping, so with enough threads it runs at the speed of the disk.
+	///
+	/// The chunk digests are kept, so a single chunk can be re-verified on its own (VerifyChunk), and
+	/// two trees of the same layout can say which chunks differ (MismatchedChunks) instead of just
+	/// "something did". Roots only compare equal for the same algorithm, chunk size and total size.
+	///
+	/// Leaves, inner nodes and the root are each hashed in their own domain (a prefix byte for SHA3, a
+	/// seed for XXH3), so a node digest can't pass as a leaf's.
+	class TreeHash
+	{
+	public:
+		using Digest = std::array<uint8_t, 32>; /// XXH3 only fills the first 16 bytes, the rest stay 0.
+
+		static constexpr uint64_t DefaultChunkSize = 4_MiB;
+
+	private:
+		TreeHashAlgorithm   m_algorithm = TreeHashAlgorithm::XXH3;
+		uint64_t            m_chunkSize = DefaultChunkSize;
+		uint64_t            m_totalSize = 0;
+		std::vector<Digest> m_leaves;
+		Digest              m_root      = {};
+
+		enum class Domain : uint8_t { Leaf = 0, Node = 1, Root = 2 };
+
+		/// Hashes (a, b) where b may be empty, as one message in the given domain.
+		static Digest hashParts(TreeHashAlgorithm alg, Domain domain, void const * a, size_t aSize, void const * b, size_t bSize)
+		{
+			Digest d = {};
+
+			if (alg == TreeHashAlgorithm::SHA3)
+			{
+				uint8_t const prefix = uint8_t(domain);
+
+				SHA3<SHA3Bits::Bits256> h;
+				h.Add(&prefix, 1);
+				h.Add(a, aSize);
+				if (bSize)
+					h.Add(b, bSize);
+
+				d = h.Get();
+			}
+			else
+			{
+				Digest128 r;
+				if (bSize == 0)
+					r = XXH3::Hash128(a, aSize, uint64_t(domain));
+				else
+				{
+					XXH3 h{ uint64_t(domain) };
+					h.Add(a, aSize);
+					h.Add(b, bSize);
+					r = h.Get128();
+				}
+
+				std::memcpy(d.data(),     &r.Low64,  8);
+				std::memcpy(d.data() + 8, &r.High64, 8);
+			}
+
+			return d;
+		}
+
+		static Digest hashLeaf(TreeHashAlgorithm alg, void const * data, size_t size) { return hashParts(alg, Domain::Leaf, data, size, nullptr, 0); }
+
+		Digest computeRoot() const
+		{
+			if (m_leaves.empty())
+				return Digest{};
+
+			size_t const digestSize = DigestSize();
+
+			std::vector<Digest> level = m_leaves;
+			while (level.size() > 1)
+			{
+				/// An odd one out moves up a level unchanged.
+				size_t const pairs = level.size() / 2;
+				for (size_t i = 0; i < pairs; i++)
+					level[i] = hashParts(m_algorithm, Domain::Node, level[2 * i].data(), digestSize, level[2 * i + 1].data(), digestSize);
+
+				if (level.size() % 2)
+					level[pairs] = level.back();
+
+				level.resize((level.size() + 1) / 2);
+			}
+
+			uint64_t const layout[2] = { m_chunkSize, m_totalSize };
+			return hashParts(m_algorithm, Domain::Root, level[0].data(), digestSize, layout, sizeof(layout));
+		}
+
+		void build(uint8_t const * data, uint64_t size, ThreadPool * pool)
+		{
+			m_totalSize = size;
+			m_leaves.assign(size_t(FastMax((size + m_chunkSize - 1) / m_chunkSize, 1_u64)), Digest{});
+
+			size_t const numChunks = m_leaves.size();
+
+			auto hashChunk = [this, data](size_t i)
+			{
+				auto [offset, chunkSize] = ChunkRange(i);
+				m_leaves[i] = hashLeaf(m_algorithm, data + offset, size_t(chunkSize));
+			};
+
+			std::unique_ptr<ThreadPool> ownPool;
+			if (numChunks > 1 && !pool)
+			{
+				ownPool = std::make_unique<ThreadPool>(FastMax(size_t(std::thread::hardware_concurrency()), size_t(1)));
+				ownPool->SetThreadNames("Handy::TreeHash");
+				pool = ownPool.get();
+			}
+
+			if (numChunks == 1 || pool->Size() == 0)
+			{
+				for (size_t i = 0; i < numChunks; i++)
+					hashChunk(i);
+			}
+			else
+			{
+				/// One job per thread, each pulling the next chunk, so the file is read roughly front to back.
+				std::atomic<size_t> next{ 0 };
+				size_t const        numJobs = FastMin(pool->Size(), numChunks);
+
+				for (size_t j = 0; j < numJobs; j++)
+					pool->AddJob([&next, &hashChunk, numChunks]
+					{
+						for (size_t i = next++; i < numChunks; i = next++)
+							hashChunk(i);
+					});
+
+				pool->Wait();
+			}
+
+			m_root = computeRoot();
+		}
+
+	public:
+		TreeHash() = default;
+
+		/// Hashes data in memory. Without a pool, a temporary one with a thread per core is made (only if
+		/// there's more than 1 chunk). With one, this waits for the whole pool to go idle, so don't
+		/// call it from a job on that same pool.
+		static TreeHash FromSpan(std::span<std::byte const> data,
+		                         TreeHashAlgorithm           algorithm = TreeHashAlgorithm::XXH3,
+		                         uint64_t                    chunkSize = DefaultChunkSize,
+		                         ThreadPool *                pool      = nullptr)
+		{
+			if (chunkSize == 0)
+				throw std::invalid_argument("TreeHash - chunkSize must be nonzero.");
+
+			TreeHash t;
+			t.m_algorithm = algorithm;
+			t.m_chunkSize = chunkSize;
+			t.build(reinterpret_cast<uint8_t const *>(data.data()), data.size(), pool);
+			return t;
+		}
+
+		/// Same as FromSpan, over a read-only mapping of the file. Empty if the file can't be opened or mapped.
+		static std::optional<TreeHash> FromFile(std::filesystem::path const & path,
+		                                        TreeHashAlgorithm             algorithm = TreeHashAlgorithm::XXH3,
+		                                        uint64_t                      chunkSize = DefaultChunkSize,
+		                                        ThreadPool *                  pool      = nullptr)
+		{
+			MMFileReadOnly file;
+			file.open(path.string().c_str());
+
+			if (!file.is_open() || (file.file_size() > 0 && !file.data()))
+				return std::optional<TreeHash>();
+
+			return FromSpan(std::span<std::byte const>(reinterpret_cast<std::byte const *>(file.data()), file.mapped_size()), algorithm, chunkSize, pool);
+		}
+
+		TreeHashAlgorithm Algorithm() const { return m_algorithm; }
+		uint64_t          ChunkSize() const { return m_chunkSize; }
+		uint64_t          TotalSize() const { return m_totalSize; }
+		size_t            NumChunks() const { return m_leaves.size(); }
+		size_t            DigestSize() const { return m_algorithm == TreeHashAlgorithm::SHA3 ? 32 : 16; }
+
+		Digest const &              Root()                  const { return m_root; }
+		Digest const &              ChunkDigest(size_t i)   const { return m_leaves.at(i); }
+		std::vector<Digest> const & ChunkDigests()          const { return m_leaves; }
+
+		/// {offset, size} of chunk i in the input. Only the last chunk can be short.
+		std::pair<uint64_t, uint64_t> ChunkRange(size_t i) const
+		{
+			uint64_t const offset = uint64_t(i) * m_chunkSize;
+			return { offset, FastMin(m_chunkSize, m_totalSize - offset) };
+		}
+
+		/// True if chunk holds exactly what chunk i held when this was computed.
+		bool VerifyChunk(size_t i, std::span<std::byte const> chunk) const
+		{
+			if (i >= m_leaves.size() || chunk.size() != ChunkRange(i).second)
+				return false;
+
+			return hashLeaf(m_algorithm, chunk.data(), chunk.size()) == m_leaves[i];
+		}
+
+		/// Indices of the chunks that differ from other. Chunks past the end of the shorter one count as
+		/// different. Throws if the two weren't computed with the same algorithm and chunk size.
+		std::vector<size_t> MismatchedChunks(TreeHash const & other) const
+		{
+			if (m_algorithm != other.m_algorithm || m_chunkSize != other.m_chunkSize)
+				throw std::invalid_argument("TreeHash - can only compare trees with the same algorithm and chunk size.");
+
+			std::vector<size_t> result;
+			size_t const        n = FastMax(m_leaves.size(), other.m_leaves.size());
+
+			for (size_t i = 0; i < n; i++)
+				if (i >= m_leaves.size() || i >= other.m_leaves.size() || m_leaves[i] != other.m_leaves[i] || ChunkRange(i) != other.ChunkRange(i))
+					result.push_back(i);
+
+			return result;
+		}
+
+		bool operator==(TreeHash const & rhs) const { return m_algorithm == rhs.m_algorithm && m_root == rhs.m_root; }
+		bool operator!=(TreeHash const & rhs) const { return !(*this == rhs); }
+
+	private:
+		friend struct HANDY_NS::Serializer<TreeHash>;
+		friend struct HANDY_NS::Deserializer<TreeHash>;
+
+		/// Layout: version, algorithm (1 byte each), chunk size, total size, chunk count (8 bytes each), then the root
+		/// and the chunk digests, DigestSize() bytes each.
+		static constexpr uint8_t FormatVersion = 1;
+		static constexpr size_t  HeaderBytes   = 2 + 3 * 8;
+
+		std::vector<std::byte> toBytes() const
+		{
+			size_t const           digestSize = DigestSize();
+			std::vector<std::byte> bytes(HeaderBytes + (m_leaves.size() + 1) * digestSize);
+			std::byte *            p          = bytes.data();
+			uint64_t const         numChunks  = m_leaves.size();
+
+			p[0] = std::byte(FormatVersion);
+			p[1] = std::byte(m_algorithm);
+			std::memcpy(p + 2,  &m_chunkSize, 8);
+			std::memcpy(p + 10, &m_totalSize, 8);
+			std::memcpy(p + 18, &numChunks,   8);
+			std::memcpy(p + HeaderBytes, m_root.data(), digestSize);
+
+			for (size_t i = 0; i < m_leaves.size(); i++)
+				std::memcpy(p + HeaderBytes + (i + 1) * digestSize, m_leaves[i].data(), digestSize);
+
+			return bytes;
+		}
+
+		/// Checks the layout adds up and the root matches the chunk digests. On failure, out is left untouched.
+		static bool fromBytes(std::span<std::byte const> bytes, TreeHash & out)
+		{
+			if (bytes.size() < HeaderBytes || uint8_t(bytes[0]) != FormatVersion || uint8_t(bytes[1]) > uint8_t(TreeHashAlgorithm::SHA3))
+				return false;
+
+			TreeHash t;
+			uint64_t numChunks;
+
+			t.m_algorithm = TreeHashAlgorithm(bytes[1]);
+			std::memcpy(&t.m_chunkSize, bytes.data() + 2,  8);
+			std::memcpy(&t.m_totalSize, bytes.data() + 10, 8);
+			std::memcpy(&numChunks,     bytes.data() + 18, 8);
+
+			size_t const digestSize = t.DigestSize();
+			size_t const numStored  = (bytes.size() - HeaderBytes) / digestSize;
+
+			if (t.m_chunkSize == 0 || numChunks != FastMax(t.m_totalSize / t.m_chunkSize + (t.m_totalSize % t.m_chunkSize != 0), 1_u64))
+				return false;
+
+			if ((bytes.size() - HeaderBytes) % digestSize != 0 || numStored == 0 || numStored - 1 != numChunks)
+				return false;
+
+			std::memcpy(t.m_root.data(), bytes.data() + HeaderBytes, digestSize);
+
+			t.m_leaves.resize(size_t(numChunks));
+			for (size_t i = 0; i < t.m_leaves.size(); i++)
+				std::memcpy(t.m_leaves[i].data(), bytes.data() + HeaderBytes + (i + 1) * digestSize, digestSize);
+
+			if (t.computeRoot() != t.m_root)
+				return false;
+
+			out = std::move(t);
+			return true;
+		}
+	};
+}
+
+namespace HANDY_NS {
+
+	/// Implement the Handy::Serializer for Handy::Hash::TreeHash:
+	template <>
+	struct Serializer<Hash::TreeHash>
+	{
+		std::vector<std::byte> bytes;
+
+		std::span<std::byte const> get_span(Hash::TreeHash const & inItem)
+		{
+			bytes = inItem.toBytes();
+			return std::span<std::byte const>(bytes.data(), bytes.size());
+		}
+	};
+
+	/// Implement the Handy::Deserializer for Handy::Hash::TreeHash. Data that isn't a consistent tree (bad
+	/// layout, or a root that doesn't match the chunk digests) leaves the destination as it was.
+	template <>
+	struct Deserializer<Hash::TreeHash>
+	{
+		Hash::TreeHash *       dest = nullptr;
+		std::vector<std::byte> temp;
+
+		std::byte * prepare_span(size_t sizeBytes, Hash::TreeHash & outItem)
+		{
+			if (sizeBytes < Hash::TreeHash::HeaderBytes)
+			{
+				#if defined HANDY_SERDE_NOISY_NULLRET
+				std::cerr << "Handy::Deserializer too small to be a TreeHash.";
+				#endif
+				return nullptr;
+			}
+
+			dest = &outItem;
+			temp.resize(sizeBytes);
+			return temp.data();
+		}
+
+		~Deserializer()
+		{
+			if (dest && !Hash::TreeHash::fromBytes(temp, *dest))
+			{
+				#if defined HANDY_SERDE_NOISY_NULLRET
+				std::cerr << "Handy::Deserializer data is not a valid TreeHash.";
+				#endif
+			}
+		}
+	};
+}
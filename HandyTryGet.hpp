@@ -38,13 +38,15 @@
 
 #include "HandyBase.hpp"
 #include "HandyCompat.hpp"
+#include "HandyFlatHash.hpp"
+#include "HandyFlatMap.hpp"
 
 namespace HANDY_NS {
 
 	///-----------------------------------------------
-	/// Helpful Try-Get functions for std::map and 
-	/// std::unordered_map, these could be duplicated 
-	/// for other collections.
+	/// Helpful Try-Get functions for std::map, 
+	/// std::unordered_map, FlatHashMap and FlatMap, 
+	/// these could be duplicated for other collections.
 	template<typename TKey, typename TVal, typename C, typename A>
 	std::optional<TVal> TryGet(std::map<TKey, TVal, C, A> const & m, TKey const & k)
 	{
@@ -133,6 +135,94 @@ namespace HANDY_NS {
 		return ret;
 	}
 
+	template<typename TKey, typename TVal, typename H, typename E>
+	std::optional<TVal> TryGet(FlatHashMap<TKey, TVal, H, E> const & m, TKey const & k)
+	{
+		auto iter = m.find(k);
+		if (iter == m.end())
+			return std::optional<TVal>();
+		return iter->second;
+	}
+
+	template<typename TKey, typename TVal, typename H, typename E>
+	TVal TryGetDef(FlatHashMap<TKey, TVal, H, E> const & m, TKey const & k, TVal const & def)
+	{
+		auto iter = m.find(k);
+		if (iter == m.end())
+			return def;
+		return iter->second;
+	}
+
+	template<typename TKey, typename Tp, typename H, typename E>
+	Tp TryGetP(FlatHashMap<TKey, Tp, H, E> const & m, TKey const & k)
+	{
+		static_assert(std::is_pointer<Tp>::value, "Compile Error: TryGetP usage with non-pointer value type.");
+
+		auto iter = m.find(k);
+		if (iter == m.end())
+			return nullptr;
+		return iter->second;
+	}
+
+	template<typename TKey, typename Tp, typename H, typename E>
+	Tp TryGetRemoveP(FlatHashMap<TKey, Tp, H, E> & m, TKey const & k)
+	{
+		static_assert(std::is_pointer<Tp>::value, "Compile Error: TryGetRemoveP usage with non-pointer value type.");
+
+		auto find = m.find(k);
+		if (find == m.end())
+			return nullptr;
+		Tp ret = find->second;
+
+		m.erase(find);
+
+		return ret;
+	}
+
+	template<typename TKey, typename TVal, typename C>
+	std::optional<TVal> TryGet(FlatMap<TKey, TVal, C> const & m, TKey const & k)
+	{
+		auto iter = m.find(k);
+		if (iter == m.end())
+			return std::optional<TVal>();
+		return iter->second;
+	}
+
+	template<typename TKey, typename TVal, typename C>
+	TVal TryGetDef(FlatMap<TKey, TVal, C> const & m, TKey const & k, TVal const & def)
+	{
+		auto iter = m.find(k);
+		if (iter == m.end())
+			return def;
+		return iter->second;
+	}
+
+	template<typename TKey, typename Tp, typename C>
+	Tp TryGetP(FlatMap<TKey, Tp, C> const & m, TKey const & k)
+	{
+		static_assert(std::is_pointer<Tp>::value, "Compile Error: TryGetP usage with non-pointer value type.");
+
+		auto iter = m.find(k);
+		if (iter == m.end())
+			return nullptr;
+		return iter->second;
+	}
+
+	template<typename TKey, typename Tp, typename C>
+	Tp TryGetRemoveP(FlatMap<TKey, Tp, C> & m, TKey const & k)
+	{
+		static_assert(std::is_pointer<Tp>::value, "Compile Error: TryGetRemoveP usage with non-pointer value type.");
+
+		auto find = m.find(k);
+		if (find == m.end())
+			return nullptr;
+		Tp ret = find->second;
+
+		m.erase(find);
+
+		return ret;
+	}
+
 	template<typename TKey, typename TVal, typename C, typename A>
 	bool Contains(std::map<TKey, TVal, C, A> const & m, TKey const & k)
 	{
@@ -147,6 +237,18 @@ namespace HANDY_NS {
 		return iter != m.end();
 	}
 
+	template<typename TKey, typename TVal, typename H, typename E>
+	bool Contains(FlatHashMap<TKey, TVal, H, E> const & m, TKey const & k)
+	{
+		return m.contains(k);
+	}
+
+	template<typename TKey, typename TVal, typename C>
+	bool Contains(FlatMap<TKey, TVal, C> const & m, TKey const & k)
+	{
+		return m.contains(k);
+	}
+
 	template<typename T, typename C, typename A>
 	bool Contains(std::set<T, C, A> const & m, T const & k)
 	{
@@ -162,6 +264,18 @@ namespace HANDY_NS {
 		return iter != m.end();
 	}
 
+	template<typename T, typename H, typename E>
+	bool Contains(FlatHashSet<T, H, E> const & m, T const & k)
+	{
+		return m.contains(k);
+	}
+
+	template<typename T, typename C>
+	bool Contains(FlatSet<T, C> const & m, T const & k)
+	{
+		return m.contains(k);
+	}
+
 	template<typename T, typename A>
 	bool Contains(std::vector<T, A> const & m, T const & k)
 	{
@@ -6,6 +6,7 @@
 #include "Core/Base.hpp"
 
 #include "Core/BitContinuum.hpp"
+#include "Core/RoaringBitmap.hpp"
 
 #include "Core/Vector4.hpp"
 #include "Core/Vector3.hpp"
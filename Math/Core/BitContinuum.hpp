@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Base.hpp"
+#include "BitKernels.hpp"
 #include "Popcount.hpp"
 
 namespace HANDYMATH_NS {
@@ -69,6 +70,8 @@ namespace HANDYMATH_NS {
 		
 		/// IN-PLACE!
 		void set_bit(uint64_t reqBitIndex, bool value = true);
+		void set_range  (uint64_t firstBit, uint64_t lastBit, bool value = true); /// [firstBit, lastBit)
+		void clear_range(uint64_t firstBit, uint64_t lastBit);                    /// [firstBit, lastBit)
 		void bit_not_in_place();
 		void bit_and_in_place(BitContinuum const & bb);
 		void bit_or_in_place (BitContinuum const & bb);
@@ -85,6 +88,7 @@ namespace HANDYMATH_NS {
 
 		uint64_t count() const;
 
+		class rank_select;
 
 		//bool operator[](size_t index) const;
 
@@ -229,6 +233,46 @@ namespace HANDYMATH_NS {
 			Blocks[blockIndex] &= (~(1_u64 << bitIndex));
 	}
 
+	FORCEINLINE void BitContinuum::set_range(uint64_t firstBit, uint64_t lastBit, bool value/* = true*/)
+	{
+		/// Bits past the end already read as RepeatingBit, so there's no need to grow to write that.
+		if (value == RepeatingBit)
+			lastBit = std::min(lastBit, size_bits());
+		else
+			ensure_min_bits(lastBit);
+
+		if (firstBit >= lastBit)
+			return;
+
+		uint64_t firstBlock = firstBit / BlockSize;
+		uint64_t lastBlock  = (lastBit - 1) / BlockSize;
+		uint64_t firstMask  = (~0_u64) << (firstBit % BlockSize);
+		uint64_t lastMask   = (~0_u64) >> (BlockSize - 1 - (lastBit - 1) % BlockSize);
+
+		auto apply = [value](uint64_t & block, uint64_t mask)
+		{
+			if (value)
+				block |= mask;
+			else
+				block &= ~mask;
+		};
+
+		if (firstBlock == lastBlock)
+		{
+			apply(Blocks[firstBlock], firstMask & lastMask);
+			return;
+		}
+
+		apply(Blocks[firstBlock], firstMask);
+		std::fill(Blocks.begin() + firstBlock + 1, Blocks.begin() + lastBlock, value ? (~0_u64) : 0_u64);
+		apply(Blocks[lastBlock], lastMask);
+	}
+
+	FORCEINLINE void BitContinuum::clear_range(uint64_t firstBit, uint64_t lastBit)
+	{
+		set_range(firstBit, lastBit, false);
+	}
+
 	FORCEINLINE void BitContinuum::bit_not_in_place()
 	{
 		for (auto & block : Blocks)
@@ -241,12 +285,11 @@ namespace HANDYMATH_NS {
 	{
 		ensure_min_blocks(bb.Blocks.size());
 
-		for (uint64_t blockI = 0; blockI < bb.Blocks.size(); ++blockI)
-			Blocks[blockI] &= bb.Blocks[blockI];
+		BitKernels::AndInPlace(Blocks.data(), bb.Blocks.data(), bb.Blocks.size());
 
 		/// LHS might have more blocks that rhs. We still have to bitwise AND with the fillBlockValue.
-		for (uint64_t blockI = bb.Blocks.size(); blockI < Blocks.size(); ++blockI)
-			Blocks[blockI] &= bb.fillBlockValue();
+		if (!bb.RepeatingBit)
+			std::fill(Blocks.begin() + bb.Blocks.size(), Blocks.end(), 0_u64);
 
 		RepeatingBit = RepeatingBit && bb.RepeatingBit;
 	}
@@ -255,12 +298,11 @@ namespace HANDYMATH_NS {
 	{
 		ensure_min_blocks(bb.Blocks.size());
 
-		for (uint64_t blockI = 0; blockI < bb.Blocks.size(); ++blockI)
-			Blocks[blockI] |= bb.Blocks[blockI];
+		BitKernels::OrInPlace(Blocks.data(), bb.Blocks.data(), bb.Blocks.size());
 
 		/// LHS might have more blocks that rhs. We still have to bitwise OR with the fillBlockValue.
-		for (uint64_t blockI = bb.Blocks.size(); blockI < Blocks.size(); ++blockI)
-			Blocks[blockI] |= bb.fillBlockValue();
+		if (bb.RepeatingBit)
+			std::fill(Blocks.begin() + bb.Blocks.size(), Blocks.end(), ~0_u64);
 
 		RepeatingBit = RepeatingBit || bb.RepeatingBit;
 	}
@@ -270,11 +312,7 @@ namespace HANDYMATH_NS {
 		if (!RepeatingBit)
 			return false;
 
-		for (auto & block : Blocks)
-			if (~block)
-				return false;
-
-		return true;
+		return BitKernels::FindFirstNot(Blocks.data(), Blocks.size(), ~0_u64) == Blocks.size();
 	}
 
 	FORCEINLINE bool BitContinuum::none() const
@@ -282,11 +320,7 @@ namespace HANDYMATH_NS {
 		if (RepeatingBit)
 			return false;
 
-		for (auto & block : Blocks)
-			if (block)
-				return false;
-
-		return true;
+		return BitKernels::FindFirstNot(Blocks.data(), Blocks.size(), 0_u64) == Blocks.size();
 	}
 
 	FORCEINLINE bool BitContinuum::any() const
@@ -294,11 +328,7 @@ namespace HANDYMATH_NS {
 		if (RepeatingBit)
 			return true;
 
-		for (auto & block : Blocks)
-			if (block)
-				return true;
-
-		return false;
+		return BitKernels::FindFirstNot(Blocks.data(), Blocks.size(), 0_u64) != Blocks.size();
 	}
 
 	FORCEINLINE uint64_t BitContinuum::count() const
@@ -306,12 +336,7 @@ namespace HANDYMATH_NS {
 		if (RepeatingBit)
 			return std::numeric_limits<uint64_t>::max();
 
-		int64_t num = 0;
-
-		for (auto & block : Blocks)
-			num += HANDYMATH_NS::Popcount(block);
-
-		return (uint64_t)num;
+		return BitKernels::Count(Blocks.data(), Blocks.size());
 	}
 
 	//FORCEINLINE bool BitContinuum::operator[](size_t index) const { return get_bit(index); } 
@@ -324,27 +349,26 @@ namespace HANDYMATH_NS {
 
 	FORCEINLINE bool BitContinuum::iterator::step()
 	{
-		uint64_t block = 0;
+		uint64_t const numBlocks = m_ref.Blocks.size();
+		uint64_t const fill      = m_ref.fillBlockValue();
 
-		while (true)
-		{
-			if (m_blockIndex == m_ref.Blocks.size())
-				return false;
-
-			block = m_ref.Blocks[m_blockIndex];
-
-			if (m_ref.RepeatingBit)
-				block = ~block;
-
-			block &= (~m_mask);
+		if (m_blockIndex == numBlocks)
+			return false;
 
-			if (block)
-				break;
+		uint64_t block = (m_ref.Blocks[m_blockIndex] ^ fill) & (~m_mask);
 
+		if (!block)
+		{
+			/// Skip the run of empty blocks in one go, which is most of the work for a sparse selection.
 			++m_blockIndex;
+			m_blockIndex += BitKernels::FindFirstNot(m_ref.Blocks.data() + m_blockIndex, size_t(numBlocks - m_blockIndex), fill);
 			m_mask = 0;
 
-		} 
+			if (m_blockIndex == numBlocks)
+				return false;
+
+			block = m_ref.Blocks[m_blockIndex] ^ fill;
+		}
 
 		uint8_t bitblockindex = HANDY_NS::BitscanLSB(block);
 		m_bitIndex = BlockSize * m_blockIndex + bitblockindex;
@@ -352,4 +376,137 @@ namespace HANDYMATH_NS {
 
 		return true;
 	}
+
+	///-----------------------------------------------
+	/// Rank/select index over a BitContinuum, built once in O(n) and then queried in constant time
+	/// (select does a short binary search when the set bits are very sparse). Holds a reference to 
+	/// the continuum, and goes stale if it changes: call rebuild() after modifying it.
+	///
+	/// Layout is Vigna's rank9: per superblock of 8 blocks (512 bits), the absolute rank, and the
+	/// seven in-superblock ranks packed as 9-bit fields in one more word. Select samples the 
+	/// superblock of every 512th set bit.
+	class BitContinuum::rank_select
+	{
+		static constexpr uint64_t SuperBlocks  = 8;
+		static constexpr uint64_t SelectSample = 512;
+
+		BitContinuum const &  m_ref;
+		std::vector<uint64_t> m_counts;  /// 2 per superblock: absolute rank, packed relative ranks.
+		std::vector<uint64_t> m_samples; /// Superblock holding set bit i * SelectSample.
+		uint64_t              m_total = 0;
+
+		uint64_t absRank(uint64_t superBlock) const { return m_counts[superBlock * 2]; }
+
+		uint64_t relRank(uint64_t superBlock, uint64_t j) const
+		{
+			return j ? (m_counts[superBlock * 2 + 1] >> ((j - 1) * 9)) & 0x1FF : 0;
+		}
+
+		static uint64_t selectInBlock(uint64_t block, uint64_t r)
+		{
+			#if defined USE_BMI2
+				return HANDY_NS::BitscanLSB(_pdep_u64(1_u64 << r, block));
+			#else
+				uint64_t pos = 0;
+				uint64_t c;
+
+				c = BitKernels::detail::PopcountWord(block & 0xFFFFFFFF_u64); if (r >= c) { block >>= 32; pos += 32; r -= c; }
+				c = BitKernels::detail::PopcountWord(block & 0xFFFF_u64);     if (r >= c) { block >>= 16; pos += 16; r -= c; }
+				c = BitKernels::detail::PopcountWord(block & 0xFF_u64);       if (r >= c) { block >>=  8; pos +=  8; r -= c; }
+
+				for (; r; r--)
+					block &= block - 1;
+
+				return pos + HANDY_NS::BitscanLSB(block);
+			#endif
+		}
+
+	public:
+		static constexpr uint64_t npos = std::numeric_limits<uint64_t>::max();
+
+		explicit rank_select(BitContinuum const & ref) : m_ref(ref) { rebuild(); }
+
+		void rebuild()
+		{
+			std::vector<uint64_t> const & blocks = m_ref.Blocks;
+			uint64_t const numSuper = (blocks.size() + SuperBlocks - 1) / SuperBlocks;
+
+			m_counts.assign(numSuper * 2, 0);
+			m_samples.clear();
+			m_total = 0;
+
+			for (uint64_t sb = 0; sb < numSuper; sb++)
+			{
+				uint64_t const first = sb * SuperBlocks;
+				uint64_t const last  = std::min<uint64_t>(first + SuperBlocks, blocks.size());
+
+				m_counts[sb * 2] = m_total;
+
+				uint64_t rel    = 0;
+				uint64_t packed = 0;
+				for (uint64_t w = first; w < last; w++)
+				{
+					if (w > first)
+						packed |= rel << ((w - first - 1) * 9);
+					rel += BitKernels::detail::PopcountWord(blocks[w]);
+				}
+
+				m_counts[sb * 2 + 1] = packed;
+
+				for (uint64_t next = m_samples.size() * SelectSample; next < m_total + rel; next += SelectSample)
+					m_samples.push_back(sb);
+
+				m_total += rel;
+			}
+		}
+
+		/// Set bits within the blocks, i.e. count() without regard to RepeatingBit.
+		uint64_t total() const { return m_total; }
+
+		/// Number of set bits before bitIndex.
+		uint64_t rank(uint64_t bitIndex) const
+		{
+			uint64_t const block = bitIndex / BlockSize;
+
+			if (block >= m_ref.Blocks.size())
+				return m_ref.RepeatingBit ? m_total + (bitIndex - m_ref.size_bits()) : m_total;
+
+			uint64_t const sb   = block / SuperBlocks;
+			uint64_t const bit  = bitIndex % BlockSize;
+			uint64_t const part = bit ? m_ref.Blocks[block] & ((~0_u64) >> (BlockSize - bit)) : 0_u64;
+
+			return absRank(sb) + relRank(sb, block % SuperBlocks) + BitKernels::detail::PopcountWord(part);
+		}
+
+		/// Index of the k-th (from 0) set bit, or npos if there are not that many.
+		uint64_t select(uint64_t k) const
+		{
+			if (k >= m_total)
+				return m_ref.RepeatingBit ? m_ref.size_bits() + (k - m_total) : npos;
+
+			uint64_t const s = k / SelectSample;
+			uint64_t lo = m_samples[s];
+			uint64_t hi = s + 1 < m_samples.size() ? m_samples[s + 1] : m_counts.size() / 2 - 1;
+
+			while (lo < hi)
+			{
+				uint64_t const mid = (lo + hi + 1) / 2;
+				if (absRank(mid) <= k)
+					lo = mid;
+				else
+					hi = mid - 1;
+			}
+
+			uint64_t const rem       = k - absRank(lo);
+			uint64_t const numBlocks = std::min<uint64_t>(SuperBlocks, m_ref.Blocks.size() - lo * SuperBlocks);
+
+			uint64_t j = 1;
+			while (j < numBlocks && relRank(lo, j) <= rem)
+				j++;
+			j--;
+
+			uint64_t const block = lo * SuperBlocks + j;
+			return block * BlockSize + selectInBlock(m_ref.Blocks[block], rem - relRank(lo, j));
+		}
+	};
 }
@@ -0,0 +1,352 @@
+
+/// See ../../License.txt for license info.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Base.hpp"
+#include "Popcount.hpp"
+
+#if defined IS_X64
+	#include <immintrin.h>
+#endif
+
+namespace HANDYMATH_NS {
+
+	/// Bulk operations over arrays of 64-bit words, for BitContinuum and friends. On x64, each call
+	/// goes to an AVX-512, AVX2 or scalar version, picked once from CPUInfoCached(), so one binary
+	/// runs everywhere and still uses the widest registers the machine (and OS) has.
+	namespace BitKernels {
+
+		namespace detail {
+
+			FORCEINLINE uint64_t PopcountWord(uint64_t w)
+			{
+				#if defined USE_POPCNT
+					return uint64_t(_mm_popcnt_u64(w));
+				#elif defined IS_GNU || defined IS_CLANG
+					return uint64_t(__builtin_popcountll(w));
+				#else
+					w = w - ((w >> 1) & 0x5555555555555555_u64);
+					w = (w & 0x3333333333333333_u64) + ((w >> 2) & 0x3333333333333333_u64);
+					w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0F_u64;
+					return (w * 0x0101010101010101_u64) >> 56;
+				#endif
+			}
+
+			///-----------------------------------------------
+			/// Scalar
+
+			inline void AndScalar(uint64_t * dst, uint64_t const * src, size_t n)
+			{
+				for (size_t i = 0; i < n; i++)
+					dst[i] &= src[i];
+			}
+
+			inline void OrScalar(uint64_t * dst, uint64_t const * src, size_t n)
+			{
+				for (size_t i = 0; i < n; i++)
+					dst[i] |= src[i];
+			}
+
+			inline uint64_t CountScalar(uint64_t const * src, size_t n)
+			{
+				uint64_t total = 0;
+				for (size_t i = 0; i < n; i++)
+					total += PopcountWord(src[i]);
+				return total;
+			}
+
+			inline size_t FindFirstNotScalar(uint64_t const * src, size_t n, uint64_t value)
+			{
+				for (size_t i = 0; i < n; i++)
+					if (src[i] != value)
+						return i;
+				return n;
+			}
+
+			#if defined IS_X64
+
+				TARGET_ISA("popcnt") inline uint64_t CountPOPCNT(uint64_t const * src, size_t n)
+				{
+					uint64_t total = 0;
+					for (size_t i = 0; i < n; i++)
+						total += uint64_t(_mm_popcnt_u64(src[i]));
+					return total;
+				}
+
+				///-----------------------------------------------
+				/// AVX2
+
+				TARGET_ISA("avx2") inline void AndAVX2(uint64_t * dst, uint64_t const * src, size_t n)
+				{
+					size_t i = 0;
+					for (; i + 4 <= n; i += 4)
+					{
+						__m256i a = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(dst + i));
+						__m256i b = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + i));
+						_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_and_si256(a, b));
+					}
+					for (; i < n; i++)
+						dst[i] &= src[i];
+				}
+
+				TARGET_ISA("avx2") inline void OrAVX2(uint64_t * dst, uint64_t const * src, size_t n)
+				{
+					size_t i = 0;
+					for (; i + 4 <= n; i += 4)
+					{
+						__m256i a = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(dst + i));
+						__m256i b = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + i));
+						_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_or_si256(a, b));
+					}
+					for (; i < n; i++)
+						dst[i] |= src[i];
+				}
+
+				TARGET_ISA("avx2") inline size_t FindFirstNotAVX2(uint64_t const * src, size_t n, uint64_t value)
+				{
+					__m256i const v = _mm256_set1_epi64x(int64_t(value));
+
+					size_t i = 0;
+					for (; i + 4 <= n; i += 4)
+					{
+						__m256i const eq   = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + i)), v);
+						uint32_t const neq = ~uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(eq))) & 0xF;
+						if (neq)
+							return i + HANDY_NS::BitscanLSB(neq);
+					}
+					for (; i < n; i++)
+						if (src[i] != value)
+							return i;
+					return n;
+				}
+
+				/// Per-byte popcount via a nibble lookup table, summed into the four 64-bit lanes.
+				TARGET_ISA("avx2") inline __m256i Popcount256(__m256i v)
+				{
+					__m256i const lookup = _mm256_setr_epi8(
+						0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+						0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+					__m256i const lowMask = _mm256_set1_epi8(0x0F);
+
+					__m256i const lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, lowMask));
+					__m256i const hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask));
+					return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+				}
+
+				/// Carry-save adder: h:l = a + b + c, bitwise.
+				TARGET_ISA("avx2") FORCEINLINE void CSA256(__m256i & h, __m256i & l, __m256i a, __m256i b, __m256i c)
+				{
+					__m256i const u = _mm256_xor_si256(a, b);
+					h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+					l = _mm256_xor_si256(u, c);
+				}
+
+				/// Harley-Seal: a tree of carry-save adders folds 16 vectors into ones/twos/fours/eights
+				/// counters, so only one full popcount runs per 16 vectors (Mula, Kurz & Lemire).
+				TARGET_ISA("avx2,popcnt") inline uint64_t CountAVX2(uint64_t const * src, size_t n)
+				{
+					__m256i const * data = reinterpret_cast<__m256i const *>(src);
+					size_t const numVecs = n / 4;
+
+					__m256i total    = _mm256_setzero_si256();
+					__m256i ones     = _mm256_setzero_si256();
+					__m256i twos     = _mm256_setzero_si256();
+					__m256i fours    = _mm256_setzero_si256();
+					__m256i eights   = _mm256_setzero_si256();
+					__m256i sixteens, twosA, twosB, foursA, foursB, eightsA, eightsB;
+
+					size_t i = 0;
+					for (; i + 16 <= numVecs; i += 16)
+					{
+						CSA256(twosA,    ones,   ones,   _mm256_loadu_si256(data + i +  0), _mm256_loadu_si256(data + i +  1));
+						CSA256(twosB,    ones,   ones,   _mm256_loadu_si256(data + i +  2), _mm256_loadu_si256(data + i +  3));
+						CSA256(foursA,   twos,   twos,   twosA,        twosB);
+						CSA256(twosA,    ones,   ones,   _mm256_loadu_si256(data + i +  4), _mm256_loadu_si256(data + i +  5));
+						CSA256(twosB,    ones,   ones,   _mm256_loadu_si256(data + i +  6), _mm256_loadu_si256(data + i +  7));
+						CSA256(foursB,   twos,   twos,   twosA,        twosB);
+						CSA256(eightsA,  fours,  fours,  foursA,       foursB);
+						CSA256(twosA,    ones,   ones,   _mm256_loadu_si256(data + i +  8), _mm256_loadu_si256(data + i +  9));
+						CSA256(twosB,    ones,   ones,   _mm256_loadu_si256(data + i + 10), _mm256_loadu_si256(data + i + 11));
+						CSA256(foursA,   twos,   twos,   twosA,        twosB);
+						CSA256(twosA,    ones,   ones,   _mm256_loadu_si256(data + i + 12), _mm256_loadu_si256(data + i + 13));
+						CSA256(twosB,    ones,   ones,   _mm256_loadu_si256(data + i + 14), _mm256_loadu_si256(data + i + 15));
+						CSA256(foursB,   twos,   twos,   twosA,        twosB);
+						CSA256(eightsB,  fours,  fours,  foursA,       foursB);
+						CSA256(sixteens, eights, eights, eightsA,      eightsB);
+
+						total = _mm256_add_epi64(total, Popcount256(sixteens));
+					}
+
+					total = _mm256_slli_epi64(total, 4);
+					total = _mm256_add_epi64(total, _mm256_slli_epi64(Popcount256(eights), 3));
+					total = _mm256_add_epi64(total, _mm256_slli_epi64(Popcount256(fours),  2));
+					total = _mm256_add_epi64(total, _mm256_slli_epi64(Popcount256(twos),   1));
+					total = _mm256_add_epi64(total, Popcount256(ones));
+
+					for (; i < numVecs; i++)
+						total = _mm256_add_epi64(total, Popcount256(_mm256_loadu_si256(data + i)));
+
+					uint64_t lanes[4];
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), total);
+
+					uint64_t result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+					for (size_t w = numVecs * 4; w < n; w++)
+						result += uint64_t(_mm_popcnt_u64(src[w]));
+					return result;
+				}
+
+				///-----------------------------------------------
+				/// AVX-512. Tails are done with masked loads/stores rather than a scalar loop.
+
+				TARGET_ISA("avx512f") inline void AndAVX512(uint64_t * dst, uint64_t const * src, size_t n)
+				{
+					size_t i = 0;
+					for (; i + 8 <= n; i += 8)
+						_mm512_storeu_si512(dst + i, _mm512_and_si512(_mm512_loadu_si512(dst + i), _mm512_loadu_si512(src + i)));
+
+					if (i < n)
+					{
+						__mmask8 const m = __mmask8((1u << (n - i)) - 1);
+						_mm512_mask_storeu_epi64(dst + i, m, _mm512_and_si512(_mm512_maskz_loadu_epi64(m, dst + i), _mm512_maskz_loadu_epi64(m, src + i)));
+					}
+				}
+
+				TARGET_ISA("avx512f") inline void OrAVX512(uint64_t * dst, uint64_t const * src, size_t n)
+				{
+					size_t i = 0;
+					for (; i + 8 <= n; i += 8)
+						_mm512_storeu_si512(dst + i, _mm512_or_si512(_mm512_loadu_si512(dst + i), _mm512_loadu_si512(src + i)));
+
+					if (i < n)
+					{
+						__mmask8 const m = __mmask8((1u << (n - i)) - 1);
+						_mm512_mask_storeu_epi64(dst + i, m, _mm512_or_si512(_mm512_maskz_loadu_epi64(m, dst + i), _mm512_maskz_loadu_epi64(m, src + i)));
+					}
+				}
+
+				TARGET_ISA("avx512f") inline size_t FindFirstNotAVX512(uint64_t const * src, size_t n, uint64_t value)
+				{
+					__m512i const v = _mm512_set1_epi64(int64_t(value));
+
+					size_t i = 0;
+					for (; i + 8 <= n; i += 8)
+					{
+						__mmask8 const neq = _mm512_cmpneq_epi64_mask(_mm512_loadu_si512(src + i), v);
+						if (neq)
+							return i + HANDY_NS::BitscanLSB(neq);
+					}
+
+					if (i < n)
+					{
+						__mmask8 const m   = __mmask8((1u << (n - i)) - 1);
+						__mmask8 const neq = _mm512_mask_cmpneq_epi64_mask(m, _mm512_maskz_loadu_epi64(m, src + i), v);
+						if (neq)
+							return i + HANDY_NS::BitscanLSB(neq);
+					}
+					return n;
+				}
+
+				/// With VPOPCNTDQ there's nothing left for Harley-Seal to save.
+				TARGET_ISA("avx512f,avx512vpopcntdq") inline uint64_t CountAVX512(uint64_t const * src, size_t n)
+				{
+					__m512i total = _mm512_setzero_si512();
+
+					size_t i = 0;
+					for (; i + 8 <= n; i += 8)
+						total = _mm512_add_epi64(total, _mm512_popcnt_epi64(_mm512_loadu_si512(src + i)));
+
+					if (i < n)
+					{
+						__mmask8 const m = __mmask8((1u << (n - i)) - 1);
+						total = _mm512_add_epi64(total, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(m, src + i)));
+					}
+
+					return uint64_t(_mm512_reduce_add_epi64(total));
+				}
+
+			#endif
+
+			struct Table
+			{
+				void     (*And)        (uint64_t * dst, uint64_t const * src, size_t n);
+				void     (*Or)         (uint64_t * dst, uint64_t const * src, size_t n);
+				uint64_t (*Count)      (uint64_t const * src, size_t n);
+				size_t   (*FindFirstNot)(uint64_t const * src, size_t n, uint64_t value);
+			};
+
+			inline Table PickTable()
+			{
+				Table t = { AndScalar, OrScalar, CountScalar, FindFirstNotScalar };
+
+				#if defined IS_X64
+					HANDY_NS::CPUCapabilities const & cpu = HANDY_NS::CPUInfoCached();
+
+					if (cpu.POPCNT)
+						t.Count = CountPOPCNT;
+
+					if (cpu.AVX2 && cpu.OSAVX)
+						t = { AndAVX2, OrAVX2, CountAVX2, FindFirstNotAVX2 };
+
+					if (cpu.AVX512F && cpu.OSAVX512)
+					{
+						t.And          = AndAVX512;
+						t.Or           = OrAVX512;
+						t.FindFirstNot = FindFirstNotAVX512;
+
+						if (cpu.AVX512VPOPCNTDQ)
+							t.Count = CountAVX512;
+					}
+				#endif
+
+				return t;
+			}
+
+			inline Table const & Kernels()
+			{
+				static Table const table = PickTable();
+				return table;
+			}
+
+			/// Below this many words, the call through the table costs more than it saves.
+			static constexpr size_t DispatchMinWords = 16;
+		}
+
+		/// dst[i] &= src[i], for i < n.
+		inline void AndInPlace(uint64_t * dst, uint64_t const * src, size_t n)
+		{
+			if (n < detail::DispatchMinWords)
+				detail::AndScalar(dst, src, n);
+			else
+				detail::Kernels().And(dst, src, n);
+		}
+
+		/// dst[i] |= src[i], for i < n.
+		inline void OrInPlace(uint64_t * dst, uint64_t const * src, size_t n)
+		{
+			if (n < detail::DispatchMinWords)
+				detail::OrScalar(dst, src, n);
+			else
+				detail::Kernels().Or(dst, src, n);
+		}
+
+		/// Number of set bits in the n words.
+		inline uint64_t Count(uint64_t const * src, size_t n)
+		{
+			if (n < detail::DispatchMinWords)
+				return detail::CountScalar(src, n);
+			return detail::Kernels().Count(src, n);
+		}
+
+		/// Index of the first word that isn't value, or n if they all are.
+		inline size_t FindFirstNot(uint64_t const * src, size_t n, uint64_t value)
+		{
+			if (n < detail::DispatchMinWords)
+				return detail::FindFirstNotScalar(src, n, value);
+			return detail::Kernels().FindFirstNot(src, n, value);
+		}
+	}
+}
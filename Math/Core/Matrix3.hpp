@@ -311,3 +311,5 @@ static inline std::ostream & operator<<(std::ostream& os, ::HANDYMATH_NS::Matrix
 
 	return os;
 }
+
+MAKE_TRIVIALLY_RELOCATABLE(HANDYMATH_NS::Matrix3)
@@ -684,6 +684,8 @@ MAKE_HASHABLE(HANDYMATH_NS::Matrix4,                  \
 			  t.ZCol.X, t.ZCol.Y, t.ZCol.Z, t.ZCol.W, \
 			  t.WCol.X, t.WCol.Y, t.WCol.Z, t.WCol.W)
 
+MAKE_TRIVIALLY_RELOCATABLE(HANDYMATH_NS::Matrix4)
+
 
 // This is a stripped down version of InverseTranspose_Determinant(). It is about 5 times faster 
 // than using InverseTranspose_Determinant() and throwing away the inverse.
@@ -0,0 +1,810 @@
+/// See ../../License.txt for license info.
+
+#pragma once
+
+#include "Base.hpp"
+#include "BitContinuum.hpp"
+#include "BitKernels.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace HANDYMATH_NS {
+
+	/// A compressed bitfield, for sets of indices that are too sparse (or too large) for BitContinuum.
+	/// Implemented as roaring bitmaps: the index space is cut into 64K chunks, and only chunks with
+	/// at least one bit set exist. Each one picks whichever of three containers is smallest:
+	///
+	///     Array:  the set low 16 bits, sorted. Up to 4096 of them (8 KiB).
+	///     Bitmap: 1024 words, dense, for more than 4096 bits.
+	///     Run:    (start, length - 1) pairs. Only made by optimize(), for long runs of set bits.
+	///
+	/// A single bit at index 2^32 costs one 2-byte array entry, where a BitContinuum would allocate
+	/// 512 MiB. Intersections skip chunks that are missing from either side, then intersect
+	/// container by container, so their cost tracks the smaller set rather than the index range.
+	///
+	/// The interface follows BitContinuum, except that there is no RepeatingBit: every bit past the
+	/// last one set is zero, so all() is always false and there is no bit_not().
+	class RoaringBitmap
+	{
+	public:
+		struct Container
+		{
+			static constexpr uint8_t  ArrayType  = 0;
+			static constexpr uint8_t  BitmapType = 1;
+			static constexpr uint8_t  RunType    = 2;
+			static constexpr uint32_t ArrayMax   = 4096; /// Above this, a bitmap is smaller.
+			static constexpr uint32_t NumWords   = 1024;
+
+			uint64_t              Key         = 0; /// Index >> 16.
+			uint8_t               Type        = ArrayType;
+			uint32_t              Cardinality = 0;
+			std::vector<uint16_t> Values; /// Array: sorted values. Run: (start, length - 1) pairs, sorted.
+			std::vector<uint64_t> Words;  /// Bitmap: NumWords words.
+
+			bool contains(uint16_t low) const;
+			bool set     (uint16_t low, bool value); /// Returns true if the bit changed.
+
+			void to_bitmap(); /// Any type -> Bitmap
+			void to_array();  /// Any type -> Array. Only for Cardinality <= ArrayMax.
+			void to_runs();   /// Any type -> Run
+			void expand();    /// Run -> Array or Bitmap, whichever fits.
+			void shrink();    /// Bitmap -> Array if it fits.
+
+			uint32_t num_runs() const;
+
+			template <class Fn> void for_each(Fn && fn) const; /// fn(uint16_t low), ascending.
+
+			template <class SerialOp> void serial(SerialOp & ser)
+			{
+				ser(Key);
+				ser(Type);
+				ser(Cardinality);
+				ser(Values);
+				ser(Words);
+			}
+		};
+
+	private:
+		std::vector<Container> m_containers; /// Sorted by Key.
+
+		static uint64_t keyOf(uint64_t bitIndex) { return bitIndex >> 16; }
+		static uint16_t lowOf(uint64_t bitIndex) { return uint16_t(bitIndex & 0xFFFF); }
+
+		Container const * findContainer(uint64_t key) const;
+		std::vector<Container>::iterator lowerBound(uint64_t key);
+
+		static Container intersect(Container const & a, Container const & b);
+		static void      unite    (Container & dst, Container const & src);
+
+	public:
+		RoaringBitmap() = default;
+
+		/// Only the explicit blocks of bits are converted. bits.RepeatingBit must be zero, since a
+		/// RoaringBitmap can't hold an infinite run of ones.
+		explicit RoaringBitmap(BitContinuum const & bits);
+
+		BitContinuum to_continuum() const;
+
+		void reset();
+		void swap(RoaringBitmap & rhs);
+
+		bool get_bit(uint64_t reqBitIndex) const;
+
+		/// IN-PLACE!
+		void set_bit(uint64_t reqBitIndex, bool value = true);
+		void bit_and_in_place(RoaringBitmap const & bb);
+		void bit_or_in_place (RoaringBitmap const & bb);
+
+		/// Converts each container to runs where that is smaller. Worth calling once after building
+		/// sets with long runs, before keeping them around or serializing them.
+		void optimize();
+
+		/// BY_VALUE!
+		RoaringBitmap bit_and(RoaringBitmap const & bb) const;
+		RoaringBitmap bit_or (RoaringBitmap const & bb) const;
+		RoaringBitmap with_bit_set(uint64_t reqBitIndex, bool value = true) const;
+
+		bool  all() const { return false; }
+		bool none() const { return m_containers.empty(); }
+		bool  any() const { return !m_containers.empty(); }
+
+		uint64_t count() const;
+
+		/// Approximate heap footprint of the containers.
+		uint64_t size_bytes() const;
+
+		std::vector<Container> const & containers() const { return m_containers; }
+
+		bool operator==(RoaringBitmap const & bb) const;
+		bool operator!=(RoaringBitmap const & bb) const { return !(*this == bb); }
+
+		/// Iterate the indexes of bits set, in ascending order.
+		class iterator
+		{
+		public:
+			uint64_t bit_index() const;
+			bool     step();
+
+			friend class RoaringBitmap;
+		private:
+			uint64_t m_bitIndex  = std::numeric_limits<uint64_t>::max();
+			size_t   m_container = 0;
+			uint32_t m_cursor    = 0; /// Array: next value index. Bitmap: next bit. Run: next run.
+			uint32_t m_runNext   = 0; /// Run: next bit in the current run.
+
+			RoaringBitmap const & m_ref;
+
+			iterator(RoaringBitmap const & ref);
+		};
+
+		iterator get_iterator() const;
+
+		template <class SerialOp> void serial(SerialOp & ser)
+		{
+			ser(m_containers);
+		}
+	};
+
+	///-----------------------------------------------
+	/// Container
+
+	FORCEINLINE bool RoaringBitmap::Container::contains(uint16_t low) const
+	{
+		switch (Type)
+		{
+			case ArrayType:
+				return std::binary_search(Values.begin(), Values.end(), low);
+
+			case BitmapType:
+				return (Words[low >> 6] >> (low & 63)) & 1_u64;
+
+			default:
+			{
+				/// Last run starting at or before low.
+				size_t lo = 0, hi = Values.size() / 2;
+				while (lo < hi)
+				{
+					size_t const mid = (lo + hi) / 2;
+					if (Values[mid * 2] <= low)
+						lo = mid + 1;
+					else
+						hi = mid;
+				}
+				return lo > 0 && uint32_t(low) <= uint32_t(Values[(lo - 1) * 2]) + Values[(lo - 1) * 2 + 1];
+			}
+		}
+	}
+
+	inline bool RoaringBitmap::Container::set(uint16_t low, bool value)
+	{
+		if (Type == RunType)
+		{
+			if (contains(low) == value)
+				return false;
+			expand();
+		}
+
+		if (Type == ArrayType)
+		{
+			auto it = std::lower_bound(Values.begin(), Values.end(), low);
+			bool const present = it != Values.end() && *it == low;
+
+			if (present == value)
+				return false;
+
+			if (value)
+			{
+				Values.insert(it, low);
+				if (++Cardinality > ArrayMax)
+					to_bitmap();
+			}
+			else
+			{
+				Values.erase(it);
+				--Cardinality;
+			}
+			return true;
+		}
+
+		uint64_t & word = Words[low >> 6];
+		uint64_t const bit = 1_u64 << (low & 63);
+
+		if (bool(word & bit) == value)
+			return false;
+
+		if (value)
+		{
+			word |= bit;
+			++Cardinality;
+		}
+		else
+		{
+			word &= ~bit;
+			--Cardinality;
+			shrink();
+		}
+		return true;
+	}
+
+	template <class Fn>
+	void RoaringBitmap::Container::for_each(Fn && fn) const
+	{
+		switch (Type)
+		{
+			case ArrayType:
+				for (uint16_t v : Values)
+					fn(v);
+				break;
+
+			case BitmapType:
+				for (uint32_t w = 0; w < NumWords; w++)
+					for (uint64_t word = Words[w]; word; word &= word - 1)
+						fn(uint16_t(w * 64 + HANDY_NS::BitscanLSB(word)));
+				break;
+
+			default:
+				for (size_t r = 0; r < Values.size(); r += 2)
+					for (uint32_t v = Values[r], end = uint32_t(Values[r]) + Values[r + 1]; v <= end; v++)
+						fn(uint16_t(v));
+				break;
+		}
+	}
+
+	inline void RoaringBitmap::Container::to_bitmap()
+	{
+		if (Type == BitmapType)
+			return;
+
+		std::vector<uint64_t> words(NumWords, 0_u64);
+
+		if (Type == ArrayType)
+		{
+			for (uint16_t v : Values)
+				words[v >> 6] |= 1_u64 << (v & 63);
+		}
+		else
+		{
+			for (size_t r = 0; r < Values.size(); r += 2)
+			{
+				uint32_t const first = Values[r];
+				uint32_t const last  = first + Values[r + 1]; /// Inclusive.
+
+				for (uint32_t w = first >> 6; w <= (last >> 6); w++)
+				{
+					uint64_t mask = ~0_u64;
+					if (w == (first >> 6)) mask &= (~0_u64) << (first & 63);
+					if (w == (last  >> 6)) mask &= (~0_u64) >> (63 - (last & 63));
+					words[w] |= mask;
+				}
+			}
+		}
+
+		Words = std::move(words);
+		Values.clear();
+		Values.shrink_to_fit();
+		Type = BitmapType;
+	}
+
+	inline void RoaringBitmap::Container::to_array()
+	{
+		if (Type == ArrayType)
+			return;
+
+		assert(Cardinality <= ArrayMax);
+
+		std::vector<uint16_t> values;
+		values.reserve(Cardinality);
+		for_each([&](uint16_t v) { values.push_back(v); });
+
+		Values = std::move(values);
+		Words.clear();
+		Words.shrink_to_fit();
+		Type = ArrayType;
+	}
+
+	inline uint32_t RoaringBitmap::Container::num_runs() const
+	{
+		switch (Type)
+		{
+			case ArrayType:
+			{
+				uint32_t runs = 0;
+				for (size_t i = 0; i < Values.size(); i++)
+					if (i == 0 || Values[i] != Values[i - 1] + 1)
+						runs++;
+				return runs;
+			}
+
+			case BitmapType:
+			{
+				/// A run starts at each set bit whose lower neighbour is clear.
+				uint64_t runs  = 0;
+				uint64_t carry = 0;
+				for (uint32_t w = 0; w < NumWords; w++)
+				{
+					runs += BitKernels::detail::PopcountWord(Words[w] & ~((Words[w] << 1) | carry));
+					carry = Words[w] >> 63;
+				}
+				return uint32_t(runs);
+			}
+
+			default:
+				return uint32_t(Values.size() / 2);
+		}
+	}
+
+	inline void RoaringBitmap::Container::to_runs()
+	{
+		if (Type == RunType)
+			return;
+
+		std::vector<uint16_t> runs;
+		runs.reserve(num_runs() * 2);
+
+		uint32_t start = 0, prev = 0;
+		bool     open  = false;
+
+		for_each([&](uint16_t v)
+		{
+			if (open && v == prev + 1)
+			{
+				prev = v;
+				return;
+			}
+
+			if (open)
+			{
+				runs.push_back(uint16_t(start));
+				runs.push_back(uint16_t(prev - start));
+			}
+
+			start = prev = v;
+			open  = true;
+		});
+
+		if (open)
+		{
+			runs.push_back(uint16_t(start));
+			runs.push_back(uint16_t(prev - start));
+		}
+
+		Values = std::move(runs);
+		Words.clear();
+		Words.shrink_to_fit();
+		Type = RunType;
+	}
+
+	FORCEINLINE void RoaringBitmap::Container::expand()
+	{
+		if (Type != RunType)
+			return;
+
+		if (Cardinality <= ArrayMax)
+			to_array();
+		else
+			to_bitmap();
+	}
+
+	FORCEINLINE void RoaringBitmap::Container::shrink()
+	{
+		if (Type == BitmapType && Cardinality <= ArrayMax)
+			to_array();
+	}
+
+	///-----------------------------------------------
+	/// Pairwise container operations. Runs are expanded first; results are never runs.
+
+	inline RoaringBitmap::Container RoaringBitmap::intersect(Container const & a, Container const & b)
+	{
+		if (a.Type == Container::RunType || b.Type == Container::RunType)
+		{
+			Container ea = a; ea.expand();
+			Container eb = b; eb.expand();
+			return intersect(ea, eb);
+		}
+
+		Container out;
+		out.Key = a.Key;
+
+		if (a.Type == Container::BitmapType && b.Type == Container::BitmapType)
+		{
+			out.Type  = Container::BitmapType;
+			out.Words = a.Words;
+			BitKernels::AndInPlace(out.Words.data(), b.Words.data(), Container::NumWords);
+			out.Cardinality = uint32_t(BitKernels::Count(out.Words.data(), Container::NumWords));
+			out.shrink();
+			return out;
+		}
+
+		if (a.Type == Container::ArrayType && b.Type == Container::ArrayType)
+		{
+			Container const & small = a.Cardinality <= b.Cardinality ? a : b;
+			Container const & large = a.Cardinality <= b.Cardinality ? b : a;
+
+			out.Values.reserve(small.Cardinality);
+
+			if (small.Cardinality * 32 < large.Cardinality)
+			{
+				/// Very different sizes: binary search the large one, narrowing as we go.
+				auto from = large.Values.begin();
+				for (uint16_t v : small.Values)
+				{
+					from = std::lower_bound(from, large.Values.end(), v);
+					if (from == large.Values.end())
+						break;
+					if (*from == v)
+						out.Values.push_back(v);
+				}
+			}
+			else
+			{
+				std::set_intersection(a.Values.begin(), a.Values.end(), b.Values.begin(), b.Values.end(), std::back_inserter(out.Values));
+			}
+
+			out.Cardinality = uint32_t(out.Values.size());
+			return out;
+		}
+
+		/// Array & Bitmap
+		Container const & arr = a.Type == Container::ArrayType ? a : b;
+		Container const & bmp = a.Type == Container::ArrayType ? b : a;
+
+		out.Values.reserve(arr.Cardinality);
+		for (uint16_t v : arr.Values)
+			if ((bmp.Words[v >> 6] >> (v & 63)) & 1_u64)
+				out.Values.push_back(v);
+
+		out.Cardinality = uint32_t(out.Values.size());
+		return out;
+	}
+
+	inline void RoaringBitmap::unite(Container & dst, Container const & src)
+	{
+		if (src.Type == Container::RunType)
+		{
+			Container es = src;
+			es.expand();
+			unite(dst, es);
+			return;
+		}
+
+		dst.expand();
+
+		if (dst.Type == Container::ArrayType && src.Type == Container::ArrayType)
+		{
+			std::vector<uint16_t> merged;
+			merged.reserve(dst.Values.size() + src.Values.size());
+			std::set_union(dst.Values.begin(), dst.Values.end(), src.Values.begin(), src.Values.end(), std::back_inserter(merged));
+
+			dst.Values      = std::move(merged);
+			dst.Cardinality = uint32_t(dst.Values.size());
+			if (dst.Cardinality > Container::ArrayMax)
+				dst.to_bitmap();
+			return;
+		}
+
+		dst.to_bitmap();
+
+		if (src.Type == Container::BitmapType)
+		{
+			BitKernels::OrInPlace(dst.Words.data(), src.Words.data(), Container::NumWords);
+		}
+		else
+		{
+			for (uint16_t v : src.Values)
+				dst.Words[v >> 6] |= 1_u64 << (v & 63);
+		}
+
+		dst.Cardinality = uint32_t(BitKernels::Count(dst.Words.data(), Container::NumWords));
+	}
+
+	///-----------------------------------------------
+	/// RoaringBitmap
+
+	FORCEINLINE RoaringBitmap::Container const * RoaringBitmap::findContainer(uint64_t key) const
+	{
+		auto it = std::lower_bound(m_containers.begin(), m_containers.end(), key, [](Container const & c, uint64_t k) { return c.Key < k; });
+		return it != m_containers.end() && it->Key == key ? &*it : nullptr;
+	}
+
+	FORCEINLINE std::vector<RoaringBitmap::Container>::iterator RoaringBitmap::lowerBound(uint64_t key)
+	{
+		return std::lower_bound(m_containers.begin(), m_containers.end(), key, [](Container const & c, uint64_t k) { return c.Key < k; });
+	}
+
+	inline RoaringBitmap::RoaringBitmap(BitContinuum const & bits)
+	{
+		assert(!bits.RepeatingBit);
+
+		std::vector<uint64_t> const & blocks = bits.Blocks;
+
+		for (size_t first = 0; first < blocks.size(); first += Container::NumWords)
+		{
+			size_t   const n     = std::min<size_t>(Container::NumWords, blocks.size() - first);
+			uint64_t const count = BitKernels::Count(blocks.data() + first, n);
+			if (!count)
+				continue;
+
+			Container c;
+			c.Key         = first / Container::NumWords;
+			c.Type        = Container::BitmapType;
+			c.Cardinality = uint32_t(count);
+			c.Words.assign(Container::NumWords, 0_u64);
+			std::memcpy(c.Words.data(), blocks.data() + first, n * sizeof(uint64_t));
+			c.shrink();
+
+			m_containers.push_back(std::move(c));
+		}
+	}
+
+	inline BitContinuum RoaringBitmap::to_continuum() const
+	{
+		BitContinuum ret;
+		if (m_containers.empty())
+			return ret;
+
+		ret.Blocks.assign((m_containers.back().Key + 1) * Container::NumWords, 0_u64);
+
+		for (Container const & c : m_containers)
+		{
+			uint64_t * words = ret.Blocks.data() + c.Key * Container::NumWords;
+
+			if (c.Type == Container::BitmapType)
+				std::memcpy(words, c.Words.data(), Container::NumWords * sizeof(uint64_t));
+			else if (c.Type == Container::RunType)
+				for (size_t r = 0; r < c.Values.size(); r += 2)
+					ret.set_range((c.Key << 16) + c.Values[r], (c.Key << 16) + c.Values[r] + c.Values[r + 1] + 1);
+			else
+				for (uint16_t v : c.Values)
+					words[v >> 6] |= 1_u64 << (v & 63);
+		}
+
+		/// Trim trailing zero blocks, as a BitContinuum built bit by bit wouldn't have them.
+		while (!ret.Blocks.empty() && !ret.Blocks.back())
+			ret.Blocks.pop_back();
+
+		return ret;
+	}
+
+	FORCEINLINE void RoaringBitmap::reset() { m_containers.clear(); }
+
+	FORCEINLINE void RoaringBitmap::swap(RoaringBitmap & rhs) { m_containers.swap(rhs.m_containers); }
+
+	FORCEINLINE bool RoaringBitmap::get_bit(uint64_t reqBitIndex) const
+	{
+		Container const * c = findContainer(keyOf(reqBitIndex));
+		return c && c->contains(lowOf(reqBitIndex));
+	}
+
+	inline void RoaringBitmap::set_bit(uint64_t reqBitIndex, bool value/* = true*/)
+	{
+		uint64_t const key = keyOf(reqBitIndex);
+		auto it = lowerBound(key);
+
+		if (it == m_containers.end() || it->Key != key)
+		{
+			if (!value)
+				return;
+
+			Container c;
+			c.Key = key;
+			it = m_containers.insert(it, std::move(c));
+		}
+
+		it->set(lowOf(reqBitIndex), value);
+
+		if (it->Cardinality == 0)
+			m_containers.erase(it);
+	}
+
+	inline void RoaringBitmap::bit_and_in_place(RoaringBitmap const & bb)
+	{
+		std::vector<Container> out;
+
+		auto a = m_containers.begin();
+		auto b = bb.m_containers.begin();
+
+		while (a != m_containers.end() && b != bb.m_containers.end())
+		{
+			if (a->Key < b->Key)
+			{
+				/// Skip ahead to the other side's key, rather than stepping one container at a time.
+				a = std::lower_bound(a, m_containers.end(), b->Key, [](Container const & c, uint64_t k) { return c.Key < k; });
+			}
+			else if (b->Key < a->Key)
+			{
+				b = std::lower_bound(b, bb.m_containers.end(), a->Key, [](Container const & c, uint64_t k) { return c.Key < k; });
+			}
+			else
+			{
+				Container c = intersect(*a, *b);
+				if (c.Cardinality)
+					out.push_back(std::move(c));
+				++a;
+				++b;
+			}
+		}
+
+		m_containers = std::move(out);
+	}
+
+	inline void RoaringBitmap::bit_or_in_place(RoaringBitmap const & bb)
+	{
+		std::vector<Container> out;
+		out.reserve(std::max(m_containers.size(), bb.m_containers.size()));
+
+		auto a = m_containers.begin();
+		auto b = bb.m_containers.begin();
+
+		while (a != m_containers.end() || b != bb.m_containers.end())
+		{
+			if (b == bb.m_containers.end() || (a != m_containers.end() && a->Key < b->Key))
+			{
+				out.push_back(std::move(*a++));
+			}
+			else if (a == m_containers.end() || b->Key < a->Key)
+			{
+				out.push_back(*b++);
+			}
+			else
+			{
+				unite(*a, *b);
+				out.push_back(std::move(*a));
+				++a;
+				++b;
+			}
+		}
+
+		m_containers = std::move(out);
+	}
+
+	inline void RoaringBitmap::optimize()
+	{
+		for (Container & c : m_containers)
+		{
+			c.expand();
+
+			uint64_t const runBytes  = 4 * uint64_t(c.num_runs());
+			uint64_t const currBytes = c.Type == Container::ArrayType ? 2 * uint64_t(c.Cardinality) : 8 * uint64_t(Container::NumWords);
+
+			if (runBytes < currBytes)
+				c.to_runs();
+		}
+	}
+
+	[[nodiscard]] FORCEINLINE RoaringBitmap RoaringBitmap::bit_and(RoaringBitmap const & bb) const
+	{
+		RoaringBitmap ret = *this;
+		ret.bit_and_in_place(bb);
+		return ret;
+	}
+
+	[[nodiscard]] FORCEINLINE RoaringBitmap RoaringBitmap::bit_or(RoaringBitmap const & bb) const
+	{
+		RoaringBitmap ret = *this;
+		ret.bit_or_in_place(bb);
+		return ret;
+	}
+
+	[[nodiscard]] FORCEINLINE RoaringBitmap RoaringBitmap::with_bit_set(uint64_t reqBitIndex, bool value/* = true*/) const
+	{
+		RoaringBitmap ret = *this;
+		ret.set_bit(reqBitIndex, value);
+		return ret;
+	}
+
+	FORCEINLINE uint64_t RoaringBitmap::count() const
+	{
+		uint64_t num = 0;
+		for (Container const & c : m_containers)
+			num += c.Cardinality;
+		return num;
+	}
+
+	FORCEINLINE uint64_t RoaringBitmap::size_bytes() const
+	{
+		uint64_t bytes = m_containers.capacity() * sizeof(Container);
+		for (Container const & c : m_containers)
+			bytes += c.Values.capacity() * sizeof(uint16_t) + c.Words.capacity() * sizeof(uint64_t);
+		return bytes;
+	}
+
+	FORCEINLINE bool RoaringBitmap::operator==(RoaringBitmap const & bb) const
+	{
+		if (m_containers.size() != bb.m_containers.size())
+			return false;
+
+		for (size_t i = 0; i < m_containers.size(); i++)
+		{
+			Container const & a = m_containers[i];
+			Container const & b = bb.m_containers[i];
+
+			if (a.Key != b.Key || a.Cardinality != b.Cardinality)
+				return false;
+
+			if (a.Type == b.Type)
+			{
+				if (a.Values != b.Values || a.Words != b.Words)
+					return false;
+			}
+			else if (intersect(a, b).Cardinality != a.Cardinality)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	///-----------------------------------------------
+	/// Iterator
+
+	FORCEINLINE RoaringBitmap::iterator RoaringBitmap::get_iterator() const { return iterator(*this); }
+
+	FORCEINLINE RoaringBitmap::iterator::iterator(RoaringBitmap const & ref) : m_ref(ref) { }
+
+	FORCEINLINE uint64_t RoaringBitmap::iterator::bit_index() const { return m_bitIndex; }
+
+	inline bool RoaringBitmap::iterator::step()
+	{
+		while (m_container < m_ref.m_containers.size())
+		{
+			Container const & c = m_ref.m_containers[m_container];
+			uint64_t const base = c.Key << 16;
+
+			if (c.Type == Container::ArrayType)
+			{
+				if (m_cursor < c.Values.size())
+				{
+					m_bitIndex = base + c.Values[m_cursor++];
+					return true;
+				}
+			}
+			else if (c.Type == Container::BitmapType)
+			{
+				while (m_cursor < Container::NumWords * 64)
+				{
+					uint64_t const word = c.Words[m_cursor >> 6] & ((~0_u64) << (m_cursor & 63));
+					if (word)
+					{
+						uint32_t const bit = (m_cursor & ~63u) + HANDY_NS::BitscanLSB(word);
+						m_bitIndex = base + bit;
+						m_cursor   = bit + 1;
+						return true;
+					}
+					m_cursor = (m_cursor & ~63u) + 64;
+				}
+			}
+			else
+			{
+				if (m_cursor < c.Values.size())
+				{
+					uint32_t const start = c.Values[m_cursor];
+					uint32_t const last  = start + c.Values[m_cursor + 1];
+
+					if (m_runNext < start)
+						m_runNext = start;
+
+					m_bitIndex = base + m_runNext;
+
+					if (m_runNext == last)
+						m_cursor += 2;
+					else
+						m_runNext++;
+
+					return true;
+				}
+			}
+
+			++m_container;
+			m_cursor  = 0;
+			m_runNext = 0;
+		}
+
+		return false;
+	}
+}
@@ -508,3 +508,4 @@ namespace std {
 }
 
 MAKE_HASHABLE(HANDYMATH_NS::Vector2, t.X, t.Y)
+MAKE_TRIVIALLY_RELOCATABLE(HANDYMATH_NS::Vector2)
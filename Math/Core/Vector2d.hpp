@@ -719,3 +719,4 @@ namespace std {
 }
 
 MAKE_HASHABLE(HANDYMATH_NS::Vector2d, t.X, t.Y)
+MAKE_TRIVIALLY_RELOCATABLE(HANDYMATH_NS::Vector2d)
@@ -408,3 +408,4 @@ namespace std {
 }
 
 MAKE_HASHABLE(HANDYMATH_NS::Vector2i, t.X, t.Y)
+MAKE_TRIVIALLY_RELOCATABLE(HANDYMATH_NS::Vector2i)
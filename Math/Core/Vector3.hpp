@@ -563,3 +563,4 @@ namespace std {
 }
 
 MAKE_HASHABLE(HANDYMATH_NS::Vector3, t.X, t.Y, t.Z)
+MAKE_TRIVIALLY_RELOCATABLE(HANDYMATH_NS::Vector3)
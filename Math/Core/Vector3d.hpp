@@ -541,3 +541,4 @@ namespace std {
 }
 
 MAKE_HASHABLE(HANDYMATH_NS::Vector3d, t.X, t.Y, t.Z)
+MAKE_TRIVIALLY_RELOCATABLE(HANDYMATH_NS::Vector3d)
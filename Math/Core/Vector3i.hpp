@@ -415,3 +415,4 @@ namespace std {
 }
 
 MAKE_HASHABLE(HANDYMATH_NS::Vector3i, t.X, t.Y, t.Z)
+MAKE_TRIVIALLY_RELOCATABLE(HANDYMATH_NS::Vector3i)
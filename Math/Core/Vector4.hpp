@@ -1130,3 +1130,4 @@ namespace std {
 }
 
 MAKE_HASHABLE(HANDYMATH_NS::Vector4, t.X, t.Y, t.Z, t.W)
+MAKE_TRIVIALLY_RELOCATABLE(HANDYMATH_NS::Vector4)
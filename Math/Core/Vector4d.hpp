@@ -978,4 +978,5 @@ namespace std {
 }
 
 MAKE_HASHABLE(HANDYMATH_NS::Vector4d, t.X, t.Y, t.Z, t.W)
+MAKE_TRIVIALLY_RELOCATABLE(HANDYMATH_NS::Vector4d)
 
@@ -716,3 +716,4 @@ namespace std {
 }
 
 MAKE_HASHABLE(HANDYMATH_NS::Vector4i, t.X, t.Y, t.Z, t.W)
+MAKE_TRIVIALLY_RELOCATABLE(HANDYMATH_NS::Vector4i)
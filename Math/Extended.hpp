@@ -18,4 +18,5 @@
 #include "Extended/OrthoFrame3.hpp"
 #include "Extended/OrthoProjection.hpp"
 #include "Extended/PerspectiveProjection.hpp"
+#include "Extended/SoAVector.hpp"
 #include "Extended/Xform3.hpp"
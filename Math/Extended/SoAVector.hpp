@@ -0,0 +1,652 @@
+/// See ../../License.txt for license info.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "../Core/Matrix4.hpp"
+#include "../Core/Vector3.hpp"
+#include "../Core/Vector4.hpp"
+#include "AABB3.hpp"
+
+#if defined IS_X64
+	#include <immintrin.h>
+#endif
+
+namespace HANDYMATH_NS {
+
+	namespace detail {
+
+		template <class TVec> struct SoATraits;
+
+		template <> struct SoATraits<Vector3>
+		{
+			static constexpr size_t NumLanes = 3;
+
+			static FORCEINLINE Vector3 Load(float const * p, size_t stride)
+			{
+				return Vector3(p[0], p[stride], p[stride * 2]);
+			}
+
+			static FORCEINLINE void Store(float * p, size_t stride, Vector3 const & v)
+			{
+				p[0]          = v.X;
+				p[stride]     = v.Y;
+				p[stride * 2] = v.Z;
+			}
+		};
+
+		template <> struct SoATraits<Vector4>
+		{
+			static constexpr size_t NumLanes = 4;
+
+			static FORCEINLINE Vector4 Load(float const * p, size_t stride)
+			{
+				return Vector4(p[0], p[stride], p[stride * 2], p[stride * 3]);
+			}
+
+			static FORCEINLINE void Store(float * p, size_t stride, Vector4 const & v)
+			{
+				p[0]          = v.X;
+				p[stride]     = v.Y;
+				p[stride * 2] = v.Z;
+				p[stride * 3] = v.W;
+			}
+		};
+	}
+
+	/// A vector of Vector3 or Vector4, stored as one array per component (structure of arrays) rather
+	/// than one Vector per element. A std::vector<Vector3> spends a quarter of every load on the
+	/// padding lane, and the kernels in namespace SoA below can instead work on 8 elements at a time,
+	/// one component per AVX register, with no shuffling.
+	///
+	/// All lanes live in one allocation, capacity() floats apart. Capacity is kept a multiple of 16, so
+	/// every lane is 64-byte aligned.
+	///
+	/// Element access goes through a small proxy (reference), which converts to and from the Vector
+	/// type, and exposes the individual components as float &.
+	template <class TVec>
+	class SoAVector
+	{
+	public:
+		using value_type = TVec;
+
+		static constexpr size_t NumLanes  = detail::SoATraits<TVec>::NumLanes;
+		static constexpr size_t Alignment = 64;
+		static constexpr size_t CapacityQuantum = Alignment / sizeof(float);
+
+		class reference
+		{
+		public:
+			operator TVec() const { return detail::SoATraits<TVec>::Load(m_p, m_stride); }
+
+			reference & operator=(TVec const & v)          { detail::SoATraits<TVec>::Store(m_p, m_stride, v); return *this; }
+			reference & operator=(reference const & rhs)   { return *this = TVec(rhs); }
+
+			float & X() const { return m_p[0]; }
+			float & Y() const { return m_p[m_stride]; }
+			float & Z() const { return m_p[m_stride * 2]; }
+			float & W() const { static_assert(NumLanes == 4, "Only SoAVector<Vector4> has a W lane."); return m_p[m_stride * 3]; }
+
+			friend class SoAVector;
+		private:
+			float * m_p;
+			size_t  m_stride;
+
+			reference(float * p, size_t stride) : m_p(p), m_stride(stride) { }
+		};
+
+		template <bool IsConst>
+		class iterator_base
+		{
+			using owner_t = std::conditional_t<IsConst, SoAVector const, SoAVector>;
+
+		public:
+			using value_type = TVec;
+
+			decltype(auto)  operator* () const { return (*m_owner)[m_index]; }
+			iterator_base & operator++()       { ++m_index; return *this; }
+
+			bool operator==(iterator_base const & rhs) const { return m_index == rhs.m_index; }
+			bool operator!=(iterator_base const & rhs) const { return m_index != rhs.m_index; }
+
+			friend class SoAVector;
+		private:
+			owner_t * m_owner;
+			size_t    m_index;
+
+			iterator_base(owner_t * owner, size_t index) : m_owner(owner), m_index(index) { }
+		};
+
+		using iterator       = iterator_base<false>;
+		using const_iterator = iterator_base<true>;
+
+	private:
+		float * m_data     = nullptr;
+		size_t  m_size     = 0;
+		size_t  m_capacity = 0; /// Per lane.
+
+		static float * allocate(size_t capacity)
+		{
+			return capacity ? static_cast<float *>(::operator new(capacity * NumLanes * sizeof(float), std::align_val_t(Alignment))) : nullptr;
+		}
+
+		static void deallocate(float * p)
+		{
+			if (p)
+				::operator delete(p, std::align_val_t(Alignment));
+		}
+
+		static size_t roundCapacity(size_t n) { return (n + CapacityQuantum - 1) / CapacityQuantum * CapacityQuantum; }
+
+		void reallocate(size_t newCapacity)
+		{
+			float * fresh = allocate(newCapacity);
+
+			for (size_t l = 0; l < NumLanes && m_size; l++)
+				std::memcpy(fresh + l * newCapacity, m_data + l * m_capacity, m_size * sizeof(float));
+
+			deallocate(m_data);
+			m_data     = fresh;
+			m_capacity = newCapacity;
+		}
+
+	public:
+		SoAVector() = default;
+		explicit SoAVector(size_t count, TVec const & value = TVec()) { resize(count, value); }
+		explicit SoAVector(std::vector<TVec> const & aos);
+
+		SoAVector(SoAVector const & rhs);
+		SoAVector(SoAVector && rhs) noexcept;
+		SoAVector & operator=(SoAVector const & rhs);
+		SoAVector & operator=(SoAVector && rhs) noexcept;
+		~SoAVector() { deallocate(m_data); }
+
+		size_t size()     const { return m_size; }
+		size_t capacity() const { return m_capacity; }
+		bool   empty()    const { return m_size == 0; }
+
+		void reserve(size_t n)       { if (n > m_capacity) reallocate(roundCapacity(n)); }
+		void shrink_to_fit()         { if (roundCapacity(m_size) < m_capacity) reallocate(roundCapacity(m_size)); }
+		void clear()                 { m_size = 0; }
+		void resize(size_t n, TVec const & value = TVec());
+
+		void push_back(TVec const & v);
+		void pop_back()              { assert(m_size); --m_size; }
+
+		reference operator[](size_t i)       { assert(i < m_size); return reference(m_data + i, m_capacity); }
+		TVec      operator[](size_t i) const { assert(i < m_size); return detail::SoATraits<TVec>::Load(m_data + i, m_capacity); }
+
+		/// Component arrays, each size() long (and capacity() long in storage).
+		float       * lane(size_t l)       { assert(l < NumLanes); return m_data + l * m_capacity; }
+		float const * lane(size_t l) const { assert(l < NumLanes); return m_data + l * m_capacity; }
+
+		float       * X()       { return lane(0); }
+		float const * X() const { return lane(0); }
+		float       * Y()       { return lane(1); }
+		float const * Y() const { return lane(1); }
+		float       * Z()       { return lane(2); }
+		float const * Z() const { return lane(2); }
+		float       * W()       { static_assert(NumLanes == 4, "Only SoAVector<Vector4> has a W lane."); return lane(3); }
+		float const * W() const { static_assert(NumLanes == 4, "Only SoAVector<Vector4> has a W lane."); return lane(3); }
+
+		iterator       begin()       { return iterator(this, 0); }
+		iterator       end()         { return iterator(this, m_size); }
+		const_iterator begin() const { return const_iterator(this, 0); }
+		const_iterator end()   const { return const_iterator(this, m_size); }
+
+		std::vector<TVec> ToAoS() const;
+
+		template <class SerialOp> void serial(SerialOp & ser)
+		{
+			/// Lane by lane, as plain float vectors.
+			std::vector<float> lanes[NumLanes];
+			for (size_t l = 0; l < NumLanes; l++)
+				lanes[l].assign(lane(l), lane(l) + m_size);
+
+			for (size_t l = 0; l < NumLanes; l++)
+				ser(lanes[l]);
+
+			resize(lanes[0].size());
+			for (size_t l = 0; l < NumLanes; l++)
+			{
+				assert(lanes[l].size() == m_size);
+				std::copy(lanes[l].begin(), lanes[l].end(), lane(l));
+			}
+		}
+	};
+
+	///-----------------------------------------------
+	/// SoAVector
+
+	template <class TVec>
+	SoAVector<TVec>::SoAVector(std::vector<TVec> const & aos)
+	{
+		reserve(aos.size());
+		for (TVec const & v : aos)
+			detail::SoATraits<TVec>::Store(m_data + m_size++, m_capacity, v);
+	}
+
+	template <class TVec>
+	SoAVector<TVec>::SoAVector(SoAVector const & rhs)
+		: m_data(allocate(roundCapacity(rhs.m_size)))
+		, m_size(rhs.m_size)
+		, m_capacity(roundCapacity(rhs.m_size))
+	{
+		for (size_t l = 0; l < NumLanes && m_size; l++)
+			std::memcpy(lane(l), rhs.lane(l), m_size * sizeof(float));
+	}
+
+	template <class TVec>
+	SoAVector<TVec>::SoAVector(SoAVector && rhs) noexcept
+		: m_data(rhs.m_data)
+		, m_size(rhs.m_size)
+		, m_capacity(rhs.m_capacity)
+	{
+		rhs.m_data     = nullptr;
+		rhs.m_size     = 0;
+		rhs.m_capacity = 0;
+	}
+
+	template <class TVec>
+	SoAVector<TVec> & SoAVector<TVec>::operator=(SoAVector const & rhs)
+	{
+		if (this != &rhs)
+		{
+			m_size = 0;
+			reserve(rhs.m_size);
+			m_size = rhs.m_size;
+			for (size_t l = 0; l < NumLanes && m_size; l++)
+				std::memcpy(lane(l), rhs.lane(l), m_size * sizeof(float));
+		}
+		return *this;
+	}
+
+	template <class TVec>
+	SoAVector<TVec> & SoAVector<TVec>::operator=(SoAVector && rhs) noexcept
+	{
+		if (this != &rhs)
+		{
+			deallocate(m_data);
+			m_data     = rhs.m_data;
+			m_size     = rhs.m_size;
+			m_capacity = rhs.m_capacity;
+
+			rhs.m_data     = nullptr;
+			rhs.m_size     = 0;
+			rhs.m_capacity = 0;
+		}
+		return *this;
+	}
+
+	template <class TVec>
+	void SoAVector<TVec>::resize(size_t n, TVec const & value/* = TVec()*/)
+	{
+		reserve(n);
+		for (size_t i = m_size; i < n; i++)
+			detail::SoATraits<TVec>::Store(m_data + i, m_capacity, value);
+		m_size = n;
+	}
+
+	template <class TVec>
+	FORCEINLINE void SoAVector<TVec>::push_back(TVec const & v)
+	{
+		if (m_size == m_capacity)
+			reallocate(std::max(CapacityQuantum, m_capacity * 2));
+
+		detail::SoATraits<TVec>::Store(m_data + m_size++, m_capacity, v);
+	}
+
+	template <class TVec>
+	std::vector<TVec> SoAVector<TVec>::ToAoS() const
+	{
+		std::vector<TVec> ret;
+		ret.reserve(m_size);
+		for (size_t i = 0; i < m_size; i++)
+			ret.push_back((*this)[i]);
+		return ret;
+	}
+
+	///-----------------------------------------------
+	/// Batch kernels
+
+	/// Each kernel has a scalar version and, on x64, an AVX version doing 8 elements per step. The AVX
+	/// one is picked once from CPUInfoCached(). Both use plain multiplies and adds (no FMA), and an
+	/// exact sqrt and divide, so they give the same results as each other.
+	namespace SoA {
+
+		namespace detail {
+
+			///-----------------------------------------------
+			/// Scalar. Each works on elements [first, last), so the AVX versions can finish their tails here.
+
+			template <size_t N>
+			inline void DotScalar(float const * const * a, float const * const * b, float * out, size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; i++)
+				{
+					float sum = a[0][i] * b[0][i];
+					for (size_t l = 1; l < N; l++)
+						sum += a[l][i] * b[l][i];
+					out[i] = sum;
+				}
+			}
+
+			inline void CrossScalar(float const * const * a, float const * const * b, float * const * out, size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; i++)
+				{
+					float const ax = a[0][i], ay = a[1][i], az = a[2][i];
+					float const bx = b[0][i], by = b[1][i], bz = b[2][i];
+
+					out[0][i] = ay * bz - az * by;
+					out[1][i] = az * bx - ax * bz;
+					out[2][i] = ax * by - ay * bx;
+				}
+			}
+
+			template <size_t N>
+			inline void NormalizeScalar(float * const * v, size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; i++)
+				{
+					float lsq = v[0][i] * v[0][i];
+					for (size_t l = 1; l < N; l++)
+						lsq += v[l][i] * v[l][i];
+
+					float const scale = 1.0f / std::sqrt(lsq);
+					for (size_t l = 0; l < N; l++)
+						v[l][i] *= scale;
+				}
+			}
+
+			/// m is column major, 16 floats. For N == 3, the missing w is taken as w3.
+			template <size_t N>
+			inline void TransformScalar(float const * m, float w3, float * const * v, size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; i++)
+				{
+					float const x = v[0][i], y = v[1][i], z = v[2][i];
+					float const w = N == 4 ? v[N - 1][i] : w3;
+
+					for (size_t l = 0; l < N; l++)
+						v[l][i] = m[l] * x + m[4 + l] * y + m[8 + l] * z + m[12 + l] * w;
+				}
+			}
+
+			/// Accumulates into mn/mx (3 each). Returns true if any component was NaN.
+			inline bool BoundsScalar(float const * const * v, float * mn, float * mx, size_t first, size_t last)
+			{
+				bool nan = false;
+				for (size_t i = first; i < last; i++)
+				{
+					for (size_t l = 0; l < 3; l++)
+					{
+						float const c = v[l][i];
+						nan  |= c != c;
+						mn[l] = c < mn[l] ? c : mn[l];
+						mx[l] = c > mx[l] ? c : mx[l];
+					}
+				}
+				return nan;
+			}
+
+			///-----------------------------------------------
+			/// AVX
+
+			#if defined IS_X64
+
+				template <size_t N>
+				TARGET_ISA("avx") inline void DotAVX(float const * const * a, float const * const * b, float * out, size_t first, size_t last)
+				{
+					size_t i = first;
+					for (; i + 8 <= last; i += 8)
+					{
+						__m256 sum = _mm256_mul_ps(_mm256_loadu_ps(a[0] + i), _mm256_loadu_ps(b[0] + i));
+						for (size_t l = 1; l < N; l++)
+							sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(a[l] + i), _mm256_loadu_ps(b[l] + i)));
+						_mm256_storeu_ps(out + i, sum);
+					}
+					DotScalar<N>(a, b, out, i, last);
+				}
+
+				TARGET_ISA("avx") inline void CrossAVX(float const * const * a, float const * const * b, float * const * out, size_t first, size_t last)
+				{
+					size_t i = first;
+					for (; i + 8 <= last; i += 8)
+					{
+						__m256 const ax = _mm256_loadu_ps(a[0] + i), ay = _mm256_loadu_ps(a[1] + i), az = _mm256_loadu_ps(a[2] + i);
+						__m256 const bx = _mm256_loadu_ps(b[0] + i), by = _mm256_loadu_ps(b[1] + i), bz = _mm256_loadu_ps(b[2] + i);
+
+						_mm256_storeu_ps(out[0] + i, _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by)));
+						_mm256_storeu_ps(out[1] + i, _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz)));
+						_mm256_storeu_ps(out[2] + i, _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx)));
+					}
+					CrossScalar(a, b, out, i, last);
+				}
+
+				template <size_t N>
+				TARGET_ISA("avx") inline void NormalizeAVX(float * const * v, size_t first, size_t last)
+				{
+					__m256 const one = _mm256_set1_ps(1.0f);
+
+					size_t i = first;
+					for (; i + 8 <= last; i += 8)
+					{
+						__m256 c[N];
+						for (size_t l = 0; l < N; l++)
+							c[l] = _mm256_loadu_ps(v[l] + i);
+
+						__m256 lsq = _mm256_mul_ps(c[0], c[0]);
+						for (size_t l = 1; l < N; l++)
+							lsq = _mm256_add_ps(lsq, _mm256_mul_ps(c[l], c[l]));
+
+						__m256 const scale = _mm256_div_ps(one, _mm256_sqrt_ps(lsq));
+						for (size_t l = 0; l < N; l++)
+							_mm256_storeu_ps(v[l] + i, _mm256_mul_ps(c[l], scale));
+					}
+					NormalizeScalar<N>(v, i, last);
+				}
+
+				template <size_t N>
+				TARGET_ISA("avx") inline void TransformAVX(float const * m, float w3, float * const * v, size_t first, size_t last)
+				{
+					__m256 mm[16];
+					for (size_t k = 0; k < 16; k++)
+						mm[k] = _mm256_set1_ps(m[k]);
+
+					size_t i = first;
+					for (; i + 8 <= last; i += 8)
+					{
+						__m256 const x = _mm256_loadu_ps(v[0] + i);
+						__m256 const y = _mm256_loadu_ps(v[1] + i);
+						__m256 const z = _mm256_loadu_ps(v[2] + i);
+						__m256 const w = N == 4 ? _mm256_loadu_ps(v[N - 1] + i) : _mm256_set1_ps(w3);
+
+						__m256 r[N];
+						for (size_t l = 0; l < N; l++)
+							r[l] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+								_mm256_mul_ps(mm[l],      x),
+								_mm256_mul_ps(mm[4  + l], y)),
+								_mm256_mul_ps(mm[8  + l], z)),
+								_mm256_mul_ps(mm[12 + l], w));
+
+						for (size_t l = 0; l < N; l++)
+							_mm256_storeu_ps(v[l] + i, r[l]);
+					}
+					TransformScalar<N>(m, w3, v, i, last);
+				}
+
+				TARGET_ISA("avx") inline bool BoundsAVX(float const * const * v, float * mn, float * mx, size_t first, size_t last)
+				{
+					size_t i = first;
+					bool nan = false;
+
+					if (i + 8 <= last)
+					{
+						__m256 vmn[3], vmx[3];
+						__m256 unordered = _mm256_setzero_ps();
+
+						for (size_t l = 0; l < 3; l++)
+						{
+							vmn[l] = _mm256_set1_ps(mn[l]);
+							vmx[l] = _mm256_set1_ps(mx[l]);
+						}
+
+						for (; i + 8 <= last; i += 8)
+						{
+							for (size_t l = 0; l < 3; l++)
+							{
+								__m256 const c = _mm256_loadu_ps(v[l] + i);
+								unordered = _mm256_or_ps(unordered, _mm256_cmp_ps(c, c, _CMP_UNORD_Q));
+								vmn[l] = _mm256_min_ps(c, vmn[l]);
+								vmx[l] = _mm256_max_ps(c, vmx[l]);
+							}
+						}
+
+						nan = _mm256_movemask_ps(unordered) != 0;
+
+						alignas(32) float lanes[8];
+						for (size_t l = 0; l < 3; l++)
+						{
+							_mm256_store_ps(lanes, vmn[l]);
+							mn[l] = *std::min_element(lanes, lanes + 8);
+							_mm256_store_ps(lanes, vmx[l]);
+							mx[l] = *std::max_element(lanes, lanes + 8);
+						}
+					}
+
+					return BoundsScalar(v, mn, mx, i, last) || nan;
+				}
+
+			#endif
+
+			struct Table
+			{
+				void (*Dot3)      (float const * const * a, float const * const * b, float * out, size_t first, size_t last);
+				void (*Dot4)      (float const * const * a, float const * const * b, float * out, size_t first, size_t last);
+				void (*Cross)     (float const * const * a, float const * const * b, float * const * out, size_t first, size_t last);
+				void (*Normalize3)(float * const * v, size_t first, size_t last);
+				void (*Normalize4)(float * const * v, size_t first, size_t last);
+				void (*Transform3)(float const * m, float w3, float * const * v, size_t first, size_t last);
+				void (*Transform4)(float const * m, float w3, float * const * v, size_t first, size_t last);
+				bool (*Bounds)    (float const * const * v, float * mn, float * mx, size_t first, size_t last);
+			};
+
+			inline Table PickTable()
+			{
+				Table t = { DotScalar<3>, DotScalar<4>, CrossScalar, NormalizeScalar<3>, NormalizeScalar<4>, TransformScalar<3>, TransformScalar<4>, BoundsScalar };
+
+				#if defined IS_X64
+					HANDY_NS::CPUCapabilities const & cpu = HANDY_NS::CPUInfoCached();
+
+					if (cpu.AVX && cpu.OSAVX)
+						t = { DotAVX<3>, DotAVX<4>, CrossAVX, NormalizeAVX<3>, NormalizeAVX<4>, TransformAVX<3>, TransformAVX<4>, BoundsAVX };
+				#endif
+
+				return t;
+			}
+
+			inline Table const & Kernels()
+			{
+				static Table const table = PickTable();
+				return table;
+			}
+
+			template <class TVec>
+			struct LanePtrs
+			{
+				float * P[SoAVector<TVec>::NumLanes];
+
+				LanePtrs(SoAVector<TVec> & v)                      { for (size_t l = 0; l < SoAVector<TVec>::NumLanes; l++) P[l] = v.lane(l); }
+			};
+
+			template <class TVec>
+			struct ConstLanePtrs
+			{
+				float const * P[SoAVector<TVec>::NumLanes];
+
+				ConstLanePtrs(SoAVector<TVec> const & v)           { for (size_t l = 0; l < SoAVector<TVec>::NumLanes; l++) P[l] = v.lane(l); }
+			};
+		}
+
+		/// out[i] = a[i].Dot(b[i]). out must hold a.size() floats.
+		inline void Dot(SoAVector<Vector3> const & a, SoAVector<Vector3> const & b, float * out)
+		{
+			assert(a.size() == b.size());
+			detail::Kernels().Dot3(detail::ConstLanePtrs<Vector3>(a).P, detail::ConstLanePtrs<Vector3>(b).P, out, 0, a.size());
+		}
+
+		inline void Dot(SoAVector<Vector4> const & a, SoAVector<Vector4> const & b, float * out)
+		{
+			assert(a.size() == b.size());
+			detail::Kernels().Dot4(detail::ConstLanePtrs<Vector4>(a).P, detail::ConstLanePtrs<Vector4>(b).P, out, 0, a.size());
+		}
+
+		/// out[i] = a[i].Cross(b[i]). out is resized to match, and may be a or b.
+		inline void Cross(SoAVector<Vector3> const & a, SoAVector<Vector3> const & b, SoAVector<Vector3> & out)
+		{
+			assert(a.size() == b.size());
+			out.resize(a.size());
+			detail::Kernels().Cross(detail::ConstLanePtrs<Vector3>(a).P, detail::ConstLanePtrs<Vector3>(b).P, detail::LanePtrs<Vector3>(out).P, 0, a.size());
+		}
+
+		/// IN-PLACE! v[i] = v[i].Normalized(). As with Normalized(), zero length gives NaN.
+		inline void Normalize(SoAVector<Vector3> & v) { detail::Kernels().Normalize3(detail::LanePtrs<Vector3>(v).P, 0, v.size()); }
+		inline void Normalize(SoAVector<Vector4> & v) { detail::Kernels().Normalize4(detail::LanePtrs<Vector4>(v).P, 0, v.size()); }
+
+		/// IN-PLACE! v[i] = (m * v[i].XYZ1()).XYZ(). No perspective divide.
+		inline void TransformPoints(Matrix4 const & m, SoAVector<Vector3> & v)
+		{
+			alignas(16) float mf[16];
+			m.CopyToArray(mf);
+			detail::Kernels().Transform3(mf, 1.0f, detail::LanePtrs<Vector3>(v).P, 0, v.size());
+		}
+
+		/// IN-PLACE! v[i] = (m * v[i].XYZ0()).XYZ(). Translation is ignored.
+		inline void TransformDirections(Matrix4 const & m, SoAVector<Vector3> & v)
+		{
+			alignas(16) float mf[16];
+			m.CopyToArray(mf);
+			detail::Kernels().Transform3(mf, 0.0f, detail::LanePtrs<Vector3>(v).P, 0, v.size());
+		}
+
+		/// IN-PLACE! v[i] = m * v[i].
+		inline void Transform(Matrix4 const & m, SoAVector<Vector4> & v)
+		{
+			alignas(16) float mf[16];
+			m.CopyToArray(mf);
+			detail::Kernels().Transform4(mf, 0.0f, detail::LanePtrs<Vector4>(v).P, 0, v.size());
+		}
+
+		/// The AABB3 of all the points, or AABB3::Nothing() if there are none. Like AABB3::AddPoint(),
+		/// throws on NaN.
+		inline AABB3 Bounds(SoAVector<Vector3> const & v)
+		{
+			if (v.empty())
+				return AABB3::Nothing();
+
+			float mn[3] = { v.X()[0], v.Y()[0], v.Z()[0] };
+			float mx[3] = { mn[0], mn[1], mn[2] };
+
+			if (detail::Kernels().Bounds(detail::ConstLanePtrs<Vector3>(v).P, mn, mx, 0, v.size()))
+				throw std::runtime_error("Cannot add NaN to AABB3.");
+
+			return AABB3(Vector3(mn[0], mn[1], mn[2]), Vector3(mx[0], mx[1], mx[2]));
+		}
+
+		/// Grows aabb to hold all the points.
+		inline void AddPoints(AABB3 & aabb, SoAVector<Vector3> const & v)
+		{
+			if (!v.empty() && !aabb.IsEverything())
+				aabb.AddAABB(Bounds(v));
+		}
+	}
+}
@@ -0,0 +1,120 @@
+
+/// See ../License.txt for license info.
+
+/// htd::deque vs std::deque, push/pop at both ends.
+/// Build with optimizations, e.g.: g++ -O2 -std=c++17 -I.. DequeBenchmark.cpp
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <type_traits>
+
+#include "HandyBase.hpp"
+#include "HandyDeque.hpp"
+
+#ifdef _MSC_VER
+	#pragma optimize("", off)
+	template <typename T>
+	inline void escape(T* p)
+	{
+		*reinterpret_cast<char       volatile*>(p) =
+		*reinterpret_cast<char const volatile*>(p);
+	}
+	#pragma optimize("", on)
+#else
+	// Only works on GGC/Clang: Boo.
+	void escape(void* p) { asm volatile("" : : "g"(p) : "memory"); }
+#endif
+
+static constexpr int N      = 1000000;
+static constexpr int Rounds = 20;
+
+template <typename T>
+T Value(int i)
+{
+	if constexpr (std::is_same_v<T, std::string>)
+		return std::string(1, char('a' + i % 26)); /// Short enough for the small string optimization.
+	else
+		return T(i);
+}
+
+template <typename TDeque>
+int64_t Run(char const * name, TDeque & d)
+{
+	auto t0 = std::chrono::high_resolution_clock::now();
+
+	for (int round = 0; round < Rounds; round++)
+	{
+		/// FIFO: push back, pop front.
+		for (int i = 0; i < N; i++)
+			d.push_back(Value<typename TDeque::value_type>(i));
+		for (int i = 0; i < N; i++)
+			d.pop_front();
+
+		/// FIFO the other way round.
+		for (int i = 0; i < N; i++)
+			d.push_front(Value<typename TDeque::value_type>(i));
+		for (int i = 0; i < N; i++)
+			d.pop_back();
+
+		/// LIFO at both ends.
+		for (int i = 0; i < N; i++)
+			d.push_back(Value<typename TDeque::value_type>(i));
+		for (int i = 0; i < N; i++)
+			d.pop_back();
+		for (int i = 0; i < N; i++)
+			d.push_front(Value<typename TDeque::value_type>(i));
+		for (int i = 0; i < N; i++)
+			d.pop_front();
+
+		/// Steady state queue, as WorkPool uses it.
+		for (int i = 0; i < 64; i++)
+			d.push_back(Value<typename TDeque::value_type>(i));
+		for (int i = 0; i < N; i++)
+		{
+			d.push_back(Value<typename TDeque::value_type>(i));
+			escape(&d.front());
+			d.pop_front();
+		}
+		d.clear();
+	}
+
+	auto t1 = std::chrono::high_resolution_clock::now();
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+
+	std::cout << "  " << name << ": " << (double(ns) / (double(N) * Rounds * 9)) << " ns/op" << std::endl;
+	return ns;
+}
+
+template <typename T>
+void RunAll(char const * typeName)
+{
+	std::cout << typeName << std::endl;
+
+	std::deque<T>                            sd; Run("std::deque              ", sd);
+	htd::deque<T>                            hd; Run("htd::deque (4 KiB)      ", hd);
+	htd::deque<T, std::allocator<T>, 16384>  hb; Run("htd::deque (16 KiB)     ", hb);
+	htd::deque<T, std::allocator<T>, 512>    hs; Run("htd::deque (512 B)      ", hs);
+
+	std::cout << std::endl;
+}
+
+struct Job
+{
+	uint64_t Token;
+	uint64_t Payload[3];
+
+	Job(int i = 0) : Token(uint64_t(i)), Payload{} { }
+};
+
+int main()
+{
+	RunAll<uint32_t>   ("uint32_t");
+	RunAll<uint64_t>   ("uint64_t");
+	RunAll<Job>        ("Job (32 bytes)");
+	RunAll<std::string>("std::string");
+
+	return 0;
+}
@@ -0,0 +1,45 @@
+/// See ../License.txt for license info.
+
+/// BloomFilter false positive rate against the rate asked for, across the supported range.
+/// Build with optimizations, e.g.: g++ -O2 -std=c++20 -I.. FilterTest.cpp
+
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <random>
+
+#include "Handy.hpp"
+
+int main()
+{
+	bool ok = true;
+
+	for (double target : { 0.5, 0.2, 0.1, 0.01, 1e-3, 1e-4, 1e-5 })
+	{
+		uint64_t const numKeys   = 200'000;
+		uint64_t const numProbes = uint64_t(400.0 / target); /// ~400 false positives expected, +-5% noise.
+
+		std::mt19937_64 rng(42);
+
+		Handy::BloomFilter filter(numKeys, target);
+		for (uint64_t i = 0; i < numKeys; i++)
+			filter.insert_hash(rng());
+
+		/// Fresh random hashes are, barring 1 in 2^64, not keys.
+		uint64_t positives = 0;
+		for (uint64_t i = 0; i < numProbes; i++)
+			positives += filter.contains_hash(rng());
+
+		double const measured = double(positives) / double(numProbes);
+		double const bitsKey  = double(filter.size_bytes() * 8) / double(numKeys);
+
+		/// At or under target, allowing for sampling noise, and not wastefully far under it.
+		bool const pass = measured <= target * 1.15 && measured >= target * 0.5;
+		ok &= pass;
+
+		std::printf("%s target %-8g measured %-10.4g bits/key %.2f\n", pass ? "ok  " : "FAIL", target, measured, bitsKey);
+	}
+
+	std::cout << (ok ? "OK" : "FAIL") << std::endl;
+	return ok ? 0 : 1;
+}
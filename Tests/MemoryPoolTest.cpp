@@ -0,0 +1,90 @@
+/// See ../License.txt for license info.
+
+/// MemoryPool destructor ordering across Adopt().
+/// Build e.g.: g++ -std=c++20 -I.. MemoryPoolTest.cpp ../src/HandyMemory.cpp
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "HandyBase.hpp"
+#include "HandyCompat.hpp"
+#include "HandySerDe.hpp"
+#include "HandyMemory.hpp"
+
+static std::vector<std::string> g_destroyed;
+
+struct Recorder
+{
+	std::string Name;
+
+	explicit Recorder(std::string name) : Name(std::move(name)) { }
+	~Recorder() { g_destroyed.push_back(Name); }
+};
+
+static bool Expect(std::vector<std::string> const & expected)
+{
+	if (g_destroyed == expected)
+		return true;
+
+	std::cout << "Destruction order:";
+	for (auto const & n : g_destroyed)
+		std::cout << " " << n;
+	std::cout << std::endl;
+	return false;
+}
+
+int main()
+{
+	/// Adopted objects count as made at the moment of the Adopt: after what was already in the pool, before what comes later.
+	{
+		Handy::MemoryPool a;
+		Handy::MemoryPool b;
+
+		a.Make<Recorder>("a1");
+		a.Make<Recorder>("a2");
+		b.Make<Recorder>("b1");
+		b.Make<Recorder>("b2");
+
+		a.Adopt(b);
+		a.Make<Recorder>("a3");
+
+		b.Reset();
+		if (!g_destroyed.empty())
+		{
+			std::cout << "FAIL: the adopted pool still ran destructors" << std::endl;
+			return 1;
+		}
+
+		a.Reset();
+		if (!Expect({ "a3", "b2", "b1", "a2", "a1" }))
+		{
+			std::cout << "FAIL: Adopt(MemoryPool &) destruction order" << std::endl;
+			return 1;
+		}
+	}
+
+	/// Adopting an empty pool, and adopting into an empty pool.
+	{
+		g_destroyed.clear();
+
+		Handy::MemoryPool a;
+		Handy::MemoryPool b;
+		Handy::MemoryPool c;
+
+		b.Make<Recorder>("b1");
+		a.Adopt(b);
+		a.Adopt(c);
+		a.Make<Recorder>("a1");
+
+		a.Reset();
+		if (!Expect({ "a1", "b1" }))
+		{
+			std::cout << "FAIL: Adopt into an empty pool" << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << "OK" << std::endl;
+	return 0;
+}
@@ -0,0 +1,105 @@
+/// See ../License.txt for license info.
+
+/// RingBuffer regressions: pushing an element of the buffer into a full buffer, and a throwing copy
+/// during growth. Best run under AddressSanitizer, e.g.:
+/// g++ -std=c++20 -fsanitize=address -I.. RingBufferTest.cpp
+
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include "HandyBase.hpp"
+#include "HandyUtils.hpp"
+#include "HandyRingBuffer.hpp"
+
+#define CHECK(cond) do { if (!(cond)) { std::cout << "FAIL: " #cond " (line " << __LINE__ << ")" << std::endl; return 1; } } while (0)
+
+/// Long enough to not fit in the small string buffer, so a dangling read is a heap read.
+static std::string Value(int i) { return "ring buffer value number " + std::to_string(i); }
+
+/// Copies throw once armed, and moves may throw, so reallocation has to copy.
+struct Fragile
+{
+	static inline int CopiesLeft = -1; /// Negative: never throw.
+
+	int V = 0;
+
+	explicit Fragile(int v) : V(v) { }
+	Fragile(Fragile const & rhs) : V(rhs.V)
+	{
+		if (CopiesLeft == 0)
+			throw std::runtime_error("Fragile copy");
+		if (CopiesLeft > 0)
+			--CopiesLeft;
+	}
+	Fragile(Fragile && rhs) noexcept(false) : V(rhs.V) { }
+};
+
+int main()
+{
+	/// Grow: the old storage is freed by the growth, front() must be read before that.
+	{
+		Handy::RingBuffer<std::string> rb(16);
+		for (int i = 0; i < 16; i++)
+			rb.push_back(Value(i));
+
+		CHECK(rb.size() == rb.capacity());
+		rb.push_back(rb.front());
+		CHECK(rb.size() == 17 && rb.back() == Value(0));
+
+		while (rb.size() < rb.capacity())
+			rb.push_back(Value(99));
+		rb.push_front(rb.back());
+		CHECK(rb.front() == Value(99));
+
+		rb.emplace_back(rb[3]);
+		CHECK(rb.back() == Value(2));
+	}
+
+	/// Overwrite: push_back drops front(), which is the argument.
+	{
+		Handy::RingBuffer<std::string, Handy::RingGrowth::Overwrite> rb(4);
+		for (int i = 0; i < 4; i++)
+			rb.push_back(Value(i));
+
+		rb.push_back(rb.front());
+		CHECK(rb.size() == 4 && rb.front() == Value(1) && rb.back() == Value(0));
+
+		rb.push_front(rb.back());
+		CHECK(rb.size() == 4 && rb.front() == Value(0) && rb.back() == Value(3));
+	}
+
+	/// Reject: nothing changes.
+	{
+		Handy::RingBuffer<std::string, Handy::RingGrowth::Reject> rb(2);
+		rb.push_back(Value(0));
+		rb.push_back(Value(1));
+		CHECK(!rb.push_back(rb.front()) && !rb.push_front(rb.back()));
+		CHECK(rb.size() == 2 && rb.front() == Value(0) && rb.back() == Value(1));
+	}
+
+	/// A copy that throws partway through growing leaves the buffer as it was.
+	{
+		Handy::RingBuffer<Fragile> rb(16);
+		for (int i = 0; i < 16; i++)
+			rb.emplace_back(i);
+
+		Fragile::CopiesLeft = 8;
+		bool threw = false;
+		try { rb.emplace_back(16); }
+		catch (std::runtime_error const &) { threw = true; }
+		Fragile::CopiesLeft = -1;
+
+		CHECK(threw);
+		CHECK(rb.size() == 16 && rb.capacity() == 16);
+		for (int i = 0; i < 16; i++)
+			CHECK(rb[i].V == i);
+
+		rb.emplace_back(16);
+		CHECK(rb.size() == 17 && rb.back().V == 16);
+	}
+
+	std::cout << "OK" << std::endl;
+	return 0;
+}
@@ -0,0 +1,126 @@
+
+/// ========================================================================
+/// UNLICENSE
+/// 
+/// This is free and unencumbered software released into the public domain.
+/// Anyone is free to copy, modify, publish, use, compile, sell, or
+/// distribute this software, either in source code form or as a compiled
+/// binary, for any purpose, commercial or non-commercial, and by any
+/// means.
+///
+/// In jurisdictions that recognize copyright laws, the author or authors
+/// of this software dedicate any and all copyright interest in the
+/// software to the public domain. We make this dedication for the benefit
+/// of the public at large and to the detriment of our heirs and
+/// successors. We intend this dedication to be an overt act of
+/// relinquishment in perpetuity of all present and future rights to this
+/// software under copyright law.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+/// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+/// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+/// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+/// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/// OTHER DEALINGS IN THE SOFTWARE.
+///
+/// For more information, please refer to <http://unlicense.org/>
+/// ========================================================================
+
+#include <Handy.hpp>
+
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <unistd.h>
+	#include <sys/mman.h>
+#endif
+
+namespace HANDY_NS::detail {
+
+	size_t PageSize()
+	{
+		#if defined(_WIN32)
+			static size_t const pageSize = [] { SYSTEM_INFO si; GetSystemInfo(&si); return (size_t)si.dwPageSize; }();
+		#else
+			static size_t const pageSize = (size_t)sysconf(_SC_PAGE_SIZE);
+		#endif
+
+		return pageSize;
+	}
+
+	size_t HugePageSize()
+	{
+		/// 2 MiB is the transparent huge page size on x86-64 and (most) ARM64 kernels.
+		return (size_t)2_MiB;
+	}
+
+	size_t PageRoundUp(size_t sizeBytes, bool hugePages)
+	{
+		size_t const granularity = hugePages ? HugePageSize() : PageSize();
+		return ((FastMax(sizeBytes, (size_t)1) + granularity - 1) / granularity) * granularity;
+	}
+
+	void * PageAlloc(size_t sizeBytes, bool hugePages)
+	{
+		#if defined(_WIN32)
+			(void)hugePages; /// Large pages on Windows require SeLockMemoryPrivilege, not worth it here.
+			return VirtualAlloc(nullptr, sizeBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		#else
+			if (!hugePages)
+			{
+				void * p = mmap(nullptr, sizeBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				return p == MAP_FAILED ? nullptr : p;
+			}
+
+			/// Over-map so we can align the block on a huge page boundary, then give back the slop at either end.
+			size_t const align   = HugePageSize();
+			size_t const mapSize = sizeBytes + align;
+
+			void * p = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (p == MAP_FAILED)
+				return nullptr;
+
+			uintptr_t const start   = (uintptr_t)p;
+			uintptr_t const aligned = (start + align - 1) & ~(uintptr_t)(align - 1);
+
+			if (aligned != start)
+				munmap(p, aligned - start);
+
+			size_t const tail = (start + mapSize) - (aligned + sizeBytes);
+			if (tail)
+				munmap((void *)(aligned + sizeBytes), tail);
+
+			#if defined MADV_HUGEPAGE
+				madvise((void *)aligned, sizeBytes, MADV_HUGEPAGE);
+			#endif
+
+			return (void *)aligned;
+		#endif
+	}
+
+	void PageFree(void * p, size_t sizeBytes)
+	{
+		if (!p)
+			return;
+
+		#if defined(_WIN32)
+			(void)sizeBytes;
+			VirtualFree(p, 0, MEM_RELEASE);
+		#else
+			munmap(p, sizeBytes);
+		#endif
+	}
+
+	void PageDiscard(void * p, size_t sizeBytes)
+	{
+		if (!p)
+			return;
+
+		#if defined(_WIN32)
+			VirtualAlloc(p, sizeBytes, MEM_RESET, PAGE_READWRITE);
+		#elif defined MADV_DONTNEED
+			madvise(p, sizeBytes, MADV_DONTNEED);
+		#endif
+	}
+}
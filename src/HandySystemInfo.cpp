@@ -303,6 +303,21 @@ namespace HANDY_NS {
 		#endif
 	}
 
+	uint64_t xgetbv0()
+	{
+		#if defined (_MSC_VER) || defined (__INTEL_COMPILER)
+		return _xgetbv(0);
+
+		#elif defined(__GNUC__) || defined(__clang__)
+		uint32_t a, d;
+		__asm("xgetbv" : "=a"(a), "=d"(d) : "c"(0) : );
+		return (uint64_t(d) << 32) | a;
+
+		#else
+		return 0;
+		#endif
+	}
+
 	CPUCapabilities CPUInfo()
 	{
 		int nIds;
@@ -438,8 +453,16 @@ namespace HANDY_NS {
 			CPU.AVX512ER = f_7_EBX_[27];
 			CPU.AVX512CD = f_7_EBX_[28];
 			CPU.SHA = f_7_EBX_[29];
+			CPU.AVX512DQ = f_7_EBX_[17];
+			CPU.AVX512BW = f_7_EBX_[30];
+			CPU.AVX512VL = f_7_EBX_[31];
 
 			CPU.PREFETCHWT1 = f_7_ECX_[0];
+			CPU.AVX512VPOPCNTDQ = f_7_ECX_[14];
+
+			uint64_t xcr0 = CPU.OSXSAVE ? xgetbv0() : 0;
+			CPU.OSAVX    = (xcr0 & 0x06) == 0x06; // XMM and YMM state
+			CPU.OSAVX512 = (xcr0 & 0xE6) == 0xE6; // ...and opmask, ZMM0-15 upper halves, ZMM16-31
 
 			CPU.LAHF = f_81_ECX_[0];
 			CPU.LZCNT = isIntel && f_81_ECX_[5];
@@ -458,6 +481,12 @@ namespace HANDY_NS {
 		return CPU;
 	}
 
+	CPUCapabilities const & CPUInfoCached()
+	{
+		static CPUCapabilities const CPU = CPUInfo();
+		return CPU;
+	}
+
 	std::string SystemInfoString() 
 	{
 		uint64_t InstalledRAM_Bytes = InstalledMemorySizeBytes();
@@ -544,6 +573,10 @@ namespace HANDY_NS {
 			InfoStr += "AVX-512 Pre-Fetch Instructions -------------------: " + std::string(CPU.AVX512PF ? "Yes" : "No") + "\r\n";
 			InfoStr += "AVX-512 Exponential and Reciprocal Instructions --: " + std::string(CPU.AVX512ER ? "Yes" : "No") + "\r\n";
 			InfoStr += "AVX-512 Conflict Detection Instructions ----------: " + std::string(CPU.AVX512CD ? "Yes" : "No") + "\r\n";
+			InfoStr += "AVX-512 Doubleword and Quadword Instructions -----: " + std::string(CPU.AVX512DQ ? "Yes" : "No") + "\r\n";
+			InfoStr += "AVX-512 Byte and Word Instructions ---------------: " + std::string(CPU.AVX512BW ? "Yes" : "No") + "\r\n";
+			InfoStr += "AVX-512 Vector Length Extensions -----------------: " + std::string(CPU.AVX512VL ? "Yes" : "No") + "\r\n";
+			InfoStr += "AVX-512 Vector Population Count ------------------: " + std::string(CPU.AVX512VPOPCNTDQ ? "Yes" : "No") + "\r\n";
 		}
 
 		InfoStr += "\r\n";